@@ -37,7 +37,7 @@ if (-not (Test-Path "bin")) {
 $tempBat = "temp_build.bat"
 @"
 @call "$vsPath"
-cl /EHsc /I include /Fe:bin\winfetch.exe src\main.cpp src\system_info.cpp src\display.cpp src\config.cpp src\ascii_art.cpp /link kernel32.lib user32.lib gdi32.lib winspool.lib shell32.lib ole32.lib oleaut32.lib uuid.lib comdlg32.lib advapi32.lib psapi.lib powrprof.lib wbemuuid.lib ws2_32.lib
+cl /EHsc /std:c++17 /I include /Fe:bin\winfetch.exe src\main.cpp src\system_info.cpp src\display.cpp src\config.cpp src\ascii_art.cpp src\plugin_modules.cpp src\result_cache.cpp src\smbios.cpp src\cpu_topology.cpp src\cpu_features.cpp src\change_monitor.cpp src\winfetch_api.cpp src\mapped_file.cpp src\package_count.cpp src\data_provider.cpp src\batch_reader.cpp src\security_status.cpp src\container_limits.cpp src\memory_pressure.cpp src\fleet_archive.cpp src\archive_cli.cpp /link kernel32.lib user32.lib gdi32.lib winspool.lib shell32.lib ole32.lib oleaut32.lib uuid.lib comdlg32.lib advapi32.lib psapi.lib powrprof.lib wbemuuid.lib ws2_32.lib slc.lib wscapi.lib wuguid.lib
 "@ | Out-File -FilePath $tempBat -Encoding ASCII
 
 try {
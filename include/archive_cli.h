@@ -0,0 +1,6 @@
+#pragma once
+
+// "winfetch archive" and "winfetch query" subcommands. argv holds the
+// arguments after the subcommand name.
+int runArchiveCommand(int argc, char* argv[]);
+int runQueryCommand(int argc, char* argv[]);
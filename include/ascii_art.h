@@ -0,0 +1,20 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "config.h"
+
+class AsciiArt {
+public:
+    explicit AsciiArt(const Config& config);
+
+    std::vector<std::string> getLogo();
+
+private:
+    std::vector<std::string> getWindowsLogo();
+    std::vector<std::string> getMinimalLogo();
+    std::vector<std::string> getDefaultLogo();
+    std::vector<std::string> getCustomLogo();
+
+    Config config;
+};
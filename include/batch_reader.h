@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Reads many small pseudo-files (procfs, sysfs) in one pass. Callers plan
+// every read with add(), then run() issues them together: through
+// io_uring on Linux (one submission each for open, read and close), or
+// on a small thread pool where io_uring is unavailable. All file contents
+// land in a single pooled buffer and are handed out as views into it,
+// which stay valid until the next add(), clear() or destruction.
+class BatchReader {
+public:
+    explicit BatchReader(size_t defaultCapacity = 4096);
+    ~BatchReader();
+
+    BatchReader(const BatchReader&) = delete;
+    BatchReader& operator=(const BatchReader&) = delete;
+
+    // Plans a read of up to capacity bytes (0 = default) and returns its
+    // index. Files are read to their end or to capacity, whichever comes
+    // first; procfs hands out seq files such as mountinfo a page at a time.
+    size_t add(const std::string& path, size_t capacity = 0);
+    void run();
+    void clear();
+
+    size_t size() const { return requests.size(); }
+    bool found(size_t index) const { return requests[index].length >= 0; }
+
+    // Empty when the file is missing or unreadable
+    std::string_view view(size_t index) const;
+
+    // First line with trailing whitespace removed
+    std::string_view firstLine(size_t index) const;
+
+    // "io_uring", "threads" or "provider" after run(); for diagnostics
+    const char* backend() const { return usedBackend; }
+
+private:
+    struct Request {
+        std::string path;
+        size_t offset = 0;
+        size_t capacity = 0;
+        long long length = -1;
+        int fd = -1;
+    };
+
+    struct Ring;
+
+    bool runIoUring();
+    void runThreadPool();
+    void runProvider();
+    void readOne(Request& request);
+
+    std::vector<Request> requests;
+    std::vector<char> pool;
+    size_t defaultCapacity;
+    size_t poolSize = 0;
+    const char* usedBackend = "";
+    std::unique_ptr<Ring> ring;
+};
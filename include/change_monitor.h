@@ -0,0 +1,34 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+
+// Subscribes to OS change notifications and maps them to the collectors
+// (COLLECT_* bits from system_info.h) whose sources changed, so a
+// long-lived process refreshes only what is stale and otherwise sleeps.
+//
+//   Windows: registry notifications on the CurrentVersion, display class
+//            and TCP/IP parameter keys; volume arrival/removal and
+//            locale/time zone broadcasts via a hidden window
+//   Linux:   mount table changes (poll on /proc/self/mountinfo), kernel
+//            uevents (drm, block, cpu, memory), rtnetlink link/address
+//            events and inotify on /etc
+class ChangeMonitor {
+public:
+    ChangeMonitor();
+    ~ChangeMonitor();
+
+    ChangeMonitor(const ChangeMonitor&) = delete;
+    ChangeMonitor& operator=(const ChangeMonitor&) = delete;
+
+    // False if no notification source could be set up
+    bool active() const;
+
+    // Blocks until at least one watched source changes or the timeout
+    // expires. Returns the collectors to refresh, 0 on timeout.
+    unsigned waitForChanges(std::chrono::milliseconds timeout);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+// Collector identifiers, combined as a bit mask for refresh()
+enum CollectorId : unsigned {
+    COLLECT_OS = 1u << 0,
+    COLLECT_CPU = 1u << 1,
+    COLLECT_MEMORY = 1u << 2,
+    COLLECT_FIRMWARE = 1u << 3,
+    COLLECT_GPU = 1u << 4,
+    COLLECT_STORAGE = 1u << 5,
+    COLLECT_NETWORK = 1u << 6,
+    COLLECT_UPTIME = 1u << 7,
+    COLLECT_WINDOWS = 1u << 8,
+    COLLECT_PACKAGES = 1u << 9,
+    COLLECT_ALL = (1u << 10) - 1
+};
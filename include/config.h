@@ -0,0 +1,53 @@
+#pragma once
+
+#include <map>
+#include <string>
+
+class Config {
+public:
+    Config();
+
+    void setDefault();
+    void loadFromFile(const std::string& filename);
+    void saveToFile(const std::string& filename);
+
+    // Getters
+    bool getUseColors() const { return useColors; }
+    bool getShowLogo() const { return showLogo; }
+    bool getShowTitle() const { return showTitle; }
+    bool getClearScreen() const { return clearScreen; }
+    std::string getLogoStyle() const { return logoStyle; }
+    int getLogoColor() const { return logoColor; }
+    int getLabelColor() const { return labelColor; }
+    int getValueColor() const { return valueColor; }
+    int getSectionColor() const { return sectionColor; }
+    int getTitleColor() const { return titleColor; }
+    int getSeparatorColor() const { return separatorColor; }
+
+    // Raw key/value access for settings without a dedicated field
+    const std::map<std::string, std::string>& getSettings() const { return settings; }
+    std::string getSetting(const std::string& key, const std::string& defaultValue = "") const;
+    int getIntSetting(const std::string& key, int defaultValue) const;
+
+    // Setters
+    void setUseColors(bool value) { useColors = value; }
+    void setShowLogo(bool value) { showLogo = value; }
+    void setShowTitle(bool value) { showTitle = value; }
+    void setClearScreen(bool value) { clearScreen = value; }
+    void setLogoStyle(const std::string& value) { logoStyle = value; }
+
+private:
+    bool useColors;
+    bool showLogo;
+    bool showTitle;
+    bool clearScreen;
+    std::string logoStyle;
+    int logoColor;
+    int labelColor;
+    int valueColor;
+    int sectionColor;
+    int titleColor;
+    int separatorColor;
+
+    std::map<std::string, std::string> settings;
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Resource limits that apply to this process rather than to the host:
+// cgroup v1/v2 memory, CPU quota and cpuset on Linux, job object limits
+// on Windows. Inside a container /proc/meminfo and the CPU count still
+// describe the host, so these are reported next to the host totals.
+struct ContainerLimits {
+    std::string container;                      // "kubernetes", "docker", "podman", "lxc", "systemd-nspawn", "wsl", "windows-container", "container" or empty
+    int cgroupVersion = 0;                      // 1 or 2 on Linux, 0 elsewhere
+    unsigned long long memoryLimitBytes = 0;    // 0 = unlimited
+    unsigned long long memoryUsedBytes = 0;     // Charged to the limit, 0 = unknown
+    double cpuQuota = 0;                        // CPUs worth of run time, 0 = unlimited
+    std::vector<unsigned> cpuset;               // CPUs the process may run on; empty = unknown
+    unsigned hostCpus = 0;
+
+    bool memoryLimited() const { return memoryLimitBytes > 0; }
+    bool cpuLimited() const { return cpuQuota > 0 || (!cpuset.empty() && cpuset.size() < hostCpus); }
+
+    // One read each of /proc/self/cgroup and /proc/self/mountinfo, then a
+    // single batch for the limit files they point at
+    static ContainerLimits detect();
+
+    // Same, from the text of those two files; limit files are read below
+    // root, so a captured tree works as well as the live one
+    static ContainerLimits fromProc(const std::string& cgroup, const std::string& mountinfo,
+                                    const std::string& root, unsigned hostCpus);
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define WINFETCH_HAVE_CPUID 1
+#endif
+
+// Processor identification and instruction set support. On x86 everything
+// comes straight from CPUID; other architectures fall back to the registry
+// (Windows) or /proc/cpuinfo (Linux).
+struct CpuIdentity {
+    std::string vendor;
+    std::string brand;
+    unsigned family = 0;
+    unsigned model = 0;
+    unsigned stepping = 0;
+
+    // From CPUID leaf 0x16; zero when the CPU does not report it
+    unsigned baseMHz = 0;
+    unsigned maxMHz = 0;
+
+    bool hypervisor = false;
+    std::string hypervisorVendor;
+
+    bool sse42 = false;
+    bool avx = false;
+    bool avx2 = false;
+    bool fma = false;
+    bool avx512f = false;
+    bool avx512bw = false;
+    bool avx512cd = false;
+    bool avx512dq = false;
+    bool avx512vl = false;
+    bool amxTile = false;
+    bool amxBf16 = false;
+    bool amxInt8 = false;
+
+    // x86-64 micro-architecture level (1-4), 0 when not x86-64
+    int featureLevel = 0;
+
+    // Short names of the notable extensions, e.g. "SSE4.2", "AVX2", "AVX-512"
+    std::vector<std::string> features;
+
+    bool fromCpuid = false;
+
+    static CpuIdentity detect();
+};
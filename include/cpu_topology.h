@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Hardware population count; every x64 CPU that runs Windows 10+ has POPCNT
+inline unsigned popcount64(uint64_t value) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    return static_cast<unsigned>(__popcnt64(value));
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+    return static_cast<unsigned>(_CountOneBits64(value));
+#elif defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_popcountll(value));
+#else
+    value = value - ((value >> 1) & 0x5555555555555555ULL);
+    value = (value & 0x3333333333333333ULL) + ((value >> 2) & 0x3333333333333333ULL);
+    value = (value + (value >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<unsigned>((value * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// One cache level/type, aggregated over all its instances
+struct CpuCache {
+    unsigned level = 0;
+    char type = 'U';                // 'D'ata, 'I'nstruction or 'U'nified
+    uint64_t sizeBytes = 0;         // Size of one instance
+    unsigned sharedBy = 0;          // Logical processors per instance
+    unsigned instances = 0;
+};
+
+// Processor topology across all processor groups
+struct CpuTopology {
+    unsigned packages = 0;
+    unsigned numaNodes = 0;
+    unsigned processorGroups = 0;
+    unsigned physicalCores = 0;
+    unsigned logicalProcessors = 0;
+
+    // Only set on hybrid parts (cores with different efficiency classes)
+    unsigned performanceCores = 0;
+    unsigned efficiencyCores = 0;
+
+    std::vector<CpuCache> caches;
+
+    bool valid() const { return logicalProcessors > 0; }
+    bool hybrid() const { return performanceCores > 0 && efficiencyCores > 0; }
+
+    // GetLogicalProcessorInformationEx on Windows, sysfs elsewhere
+    static CpuTopology detect();
+
+    // Builds the topology from a sysfs tree; root is normally
+    // /sys/devices, but a captured copy works just as well
+    static CpuTopology fromSysfs(const std::string& root);
+};
+
+// Parses a kernel CPU list such as "0-3,8-11" into CPU numbers
+std::vector<unsigned> parseCpuList(std::string_view list);
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Single funnel for the raw answers collectors get from the OS: registry
+// values, command output, firmware tables, CPUID leaves, API structs and
+// so on. Normally it just forwards to the live call. In record mode every
+// answer is also written to a capture file together with its latency; in
+// replay mode the capture is served instead of touching the OS, either at
+// full speed or with the recorded latencies.
+class DataProvider {
+public:
+    static DataProvider& instance();
+
+    bool startRecording(const std::string& path);
+    bool startReplay(const std::string& path, bool withLatency);
+
+    bool recording() const { return mode == Mode::Record; }
+    bool replaying() const { return mode == Mode::Replay; }
+
+    // Replay lookups that had no recorded answer
+    unsigned long long misses() const { return missCount; }
+
+    // An empty string stands for "the call failed"
+    std::string fetch(const std::string& kind, const std::string& key,
+                      const std::function<std::string()>& live);
+
+    // For plain structs filled in by an API call that reports success
+    template <typename T>
+    bool fetchStruct(const std::string& kind, const std::string& key, T& out,
+                     const std::function<bool(T&)>& live) {
+        static_assert(std::is_trivially_copyable<T>::value, "fetchStruct needs a plain struct");
+        std::string bytes = fetch(kind, key, [&live]() {
+            T value{};
+            if (!live(value)) {
+                return std::string();
+            }
+            return std::string(reinterpret_cast<const char*>(&value), sizeof(value));
+        });
+        if (bytes.size() != sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&out, bytes.data(), sizeof(T));
+        return true;
+    }
+
+private:
+    enum class Mode { Live, Record, Replay };
+
+    struct Answer {
+        std::string value;
+        long long latencyUs = 0;
+    };
+
+    struct Recorded {
+        std::vector<Answer> answers;
+        size_t next = 0;
+    };
+
+    DataProvider() = default;
+
+    static std::string escape(const std::string& text);
+    static std::string unescape(const std::string& text);
+
+    Mode mode = Mode::Live;
+    bool replayLatency = false;
+    unsigned long long missCount = 0;
+    std::mutex mutex;
+    std::ofstream capture;
+    std::map<std::string, Recorded> replayData;
+};
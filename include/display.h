@@ -0,0 +1,90 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "config.h"
+#include "system_info.h"
+#include "ascii_art.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+// ANSI color codes, as used in the configuration file
+enum {
+    COLOR_BLACK = 30,
+    COLOR_RED = 31,
+    COLOR_GREEN = 32,
+    COLOR_YELLOW = 33,
+    COLOR_BLUE = 34,
+    COLOR_MAGENTA = 35,
+    COLOR_CYAN = 36,
+    COLOR_WHITE = 37,
+    COLOR_BRIGHT_BLACK = 90,
+    COLOR_BRIGHT_WHITE = 97
+};
+
+#ifdef _WIN32
+// Matching Windows console text attributes
+const WORD WIN_COLOR_BLACK = 0;
+const WORD WIN_COLOR_RED = FOREGROUND_RED | FOREGROUND_INTENSITY;
+const WORD WIN_COLOR_GREEN = FOREGROUND_GREEN | FOREGROUND_INTENSITY;
+const WORD WIN_COLOR_YELLOW = FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_INTENSITY;
+const WORD WIN_COLOR_BLUE = FOREGROUND_BLUE | FOREGROUND_INTENSITY;
+const WORD WIN_COLOR_MAGENTA = FOREGROUND_RED | FOREGROUND_BLUE | FOREGROUND_INTENSITY;
+const WORD WIN_COLOR_CYAN = FOREGROUND_GREEN | FOREGROUND_BLUE | FOREGROUND_INTENSITY;
+const WORD WIN_COLOR_WHITE = FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE;
+const WORD WIN_COLOR_BRIGHT_WHITE = FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE | FOREGROUND_INTENSITY;
+#endif
+
+class Display {
+public:
+    explicit Display(const Config& config);
+    ~Display();
+
+    void showSystemInfo(const SystemInfo& sysInfo);
+    void printLogo();
+    void printSeparator();
+    void printTitle();
+
+private:
+    // Colored and plain output are separate instantiations chosen once per
+    // call above, so the plain one has no color checks or console calls
+    template <bool Colors> void render(const SystemInfo& sysInfo);
+    template <bool Colors> void printLogo();
+    template <bool Colors> void printSeparator();
+    template <bool Colors> void printTitle();
+    template <bool Colors> void printInfoLine(const std::string& label, const std::string& value, int color);
+    template <bool Colors> void printSection(const char* title);
+    template <bool Colors> void setColor(int color);
+    template <bool Colors> void resetColor();
+
+    void printCentered(const std::string& text);
+    void printRightAligned(const std::string& text, int width);
+    void printLeftAligned(const std::string& text, int width);
+    std::string formatInfoLine(const std::string& label, const std::string& value);
+
+    template <bool Colors> void printSystemInfo(const SystemInfo& sysInfo);
+    template <bool Colors> void printHardwareInfo(const SystemInfo& sysInfo);
+    template <bool Colors> void printStorageInfo(const SystemInfo& sysInfo);
+    template <bool Colors> void printDesktopInfo(const SystemInfo& sysInfo);
+    template <bool Colors> void printWindowsInfo(const SystemInfo& sysInfo);
+    template <bool Colors> void printCustomInfo(const SystemInfo& sysInfo);
+
+    // Config values read once instead of on every printed line
+    struct Palette {
+        int logo;
+        int label;
+        int section;
+        int title;
+        int separator;
+    };
+
+    Config config;
+    AsciiArt asciiArt;
+    Palette palette;
+    bool useColors;
+#ifdef _WIN32
+    HANDLE hConsole;
+#endif
+};
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "mapped_file.h"
+
+// Columnar archive of many winfetch --json snapshots: one row per
+// snapshot, one column per key. Columns whose values are all unsigned
+// integers (byte counts, uptime, build numbers) are stored as numbers;
+// every other column is interned into its own dictionary and stored as
+// codes, so a GPU driver string shared by 40k hosts is kept once. Numbers
+// and codes use the narrowest of 1, 2, 4 or 8 bytes that fits the column.
+// The file is little endian and is queried through a memory mapping,
+// without being loaded.
+class ArchiveWriter {
+public:
+    using Snapshot = std::vector<std::pair<std::string, std::string>>;
+
+    void add(const Snapshot& snapshot);
+    uint64_t rows() const { return rowCount; }
+    size_t columnCount() const { return columns.size(); }
+    bool write(const std::string& path) const;
+
+    // Appends every flat JSON object in text, as printed by --json or one
+    // per line, and returns how many were read. Malformed objects are
+    // skipped.
+    static size_t parseSnapshots(std::string_view text, std::vector<Snapshot>& snapshots);
+
+private:
+    struct Column {
+        std::string name;
+        std::vector<uint32_t> codes;                            // Per row, 0 = missing
+        std::deque<std::string> strings;                        // Code - 1 -> value; stable for lookup
+        std::unordered_map<std::string_view, uint32_t> lookup;
+    };
+
+    std::deque<Column> columns;                                 // Never relocated, so lookup keys stay valid
+    std::unordered_map<std::string, size_t> columnIndex;
+    uint64_t rowCount = 0;
+};
+
+class FleetArchive {
+public:
+    struct Column {
+        std::string_view name;
+        bool numeric = false;
+        unsigned width = 0;                     // Bytes per row
+        const unsigned char* data = nullptr;
+        uint64_t dictionarySize = 0;            // String columns: distinct values
+        const unsigned char* offsets = nullptr; // dictionarySize + 1 offsets into strings
+        const char* strings = nullptr;
+    };
+
+    explicit FleetArchive(const std::string& path);
+
+    FleetArchive(const FleetArchive&) = delete;
+    FleetArchive& operator=(const FleetArchive&) = delete;
+
+    bool valid() const { return isValid; }
+    uint64_t rows() const { return rowCount; }
+    const std::vector<Column>& columns() const { return columnList; }
+    const Column* column(std::string_view name) const;
+
+    // Stored value of a row: the number, or the dictionary code of a
+    // string column
+    static uint64_t value(const Column& column, uint64_t row);
+    static bool isMissing(const Column& column, uint64_t value);
+
+    // Dictionary entry of a string column; code 0 is "missing"
+    std::string_view string(const Column& column, uint64_t code) const;
+
+    // Value of a row as text, empty when missing
+    std::string text(const Column& column, uint64_t row) const;
+
+private:
+    MappedFile file;
+    std::vector<Column> columnList;
+    uint64_t rowCount = 0;
+    bool isValid = false;
+};
+
+// Filters, group-bys and histograms over a FleetArchive. Rows are split
+// into chunks scanned on all cores. String filters are resolved against
+// the dictionary once, so the scan itself only compares integers.
+class ArchiveQuery {
+public:
+    struct Bucket {
+        double low;
+        double high;
+        uint64_t count;
+    };
+
+    explicit ArchiveQuery(const FleetArchive& archive);
+
+    // "column op value" or "column/column op value", where op is one of
+    // = != < <= > >= or ~ (substring). Numbers may end in % (10% = 0.1)
+    // or K, M, G, T (binary units). Filters are ANDed; a row missing a
+    // filtered column never matches.
+    bool where(const std::string& expression, std::string& error);
+
+    uint64_t count() const;
+
+    // Matching rows per value of column, most common first; rows without
+    // the column are counted under "(missing)"
+    std::vector<std::pair<std::string, uint64_t>> countBy(const std::string& column, std::string& error) const;
+
+    // Equal-width buckets over a numeric column
+    std::vector<Bucket> histogram(const std::string& column, unsigned buckets, std::string& error) const;
+
+    // The column's value for every matching row, in archive order
+    std::vector<std::string> list(const std::string& column, std::string& error) const;
+
+private:
+    enum Op { EQUAL, NOT_EQUAL, LESS, LESS_EQUAL, GREATER, GREATER_EQUAL, CONTAINS };
+
+    struct Filter {
+        const FleetArchive::Column* column = nullptr;
+        const FleetArchive::Column* divisor = nullptr;  // Numeric ratio column / divisor
+        Op op = EQUAL;
+        double number = 0;
+        std::vector<char> pass;                         // String columns: result per dictionary code
+    };
+
+    bool matches(uint64_t row) const;
+
+    const FleetArchive& archive;
+    std::vector<Filter> filters;
+};
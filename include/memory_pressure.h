@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string_view>
+
+// Memory counters beyond total and available: commit charge, page file
+// or swap, the file cache and huge pages, plus PSI stall averages on
+// Linux. Linux also fills in the totals, which Windows gets from
+// GlobalMemoryStatusEx. One sample is a single batched read of two procfs files (Linux)
+// or a few system calls (Windows), cheap enough for every watch tick.
+struct MemoryPressure {
+    unsigned long long totalBytes = 0;              // MemTotal; Linux only
+    unsigned long long availableBytes = 0;          // MemAvailable; Linux only
+    unsigned long long commitBytes = 0;             // Commit charge (Committed_AS on Linux)
+    unsigned long long commitLimitBytes = 0;
+    unsigned long long swapTotalBytes = 0;          // Page files on Windows
+    unsigned long long swapUsedBytes = 0;
+    unsigned long long cachedBytes = 0;             // Standby list on Windows, page cache on Linux
+    unsigned long long dirtyBytes = 0;              // Modified pages not yet written back
+    unsigned long long hugePageBytes = 0;           // Size of one huge (large) page, 0 = unsupported
+    unsigned long long hugePagesTotal = 0;          // Reserved hugetlbfs pool, in pages
+    unsigned long long hugePagesFree = 0;
+    unsigned long long transparentHugeBytes = 0;    // Anonymous transparent huge pages in use
+
+    // Linux PSI: percentage of time some, or all, non-idle tasks were
+    // stalled waiting for memory, averaged over 10, 60 and 300 seconds
+    bool hasPressure = false;
+    double someAvg[3] = {0, 0, 0};
+    double fullAvg[3] = {0, 0, 0};
+
+    static MemoryPressure sample();
+
+    // From the text of /proc/meminfo and /proc/pressure/memory; either
+    // may be empty
+    static MemoryPressure fromProc(std::string_view meminfo, std::string_view pressure);
+};
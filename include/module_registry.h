@@ -0,0 +1,70 @@
+#pragma once
+
+#include "collectors.h"
+
+// Collectors compiled into this build, as a CollectorId mask. CMake sets
+// it from WINFETCH_MODULES (e.g. -DWINFETCH_MODULES=os;cpu;memory); the
+// default is every module.
+#ifndef WINFETCH_ENABLED_MODULES
+#define WINFETCH_ENABLED_MODULES 0x3FF
+#endif
+
+// Per-module switches for code that must disappear entirely (collector
+// bodies and the helpers only they link against). Bit positions follow
+// CollectorId; the static_asserts below keep the two in step.
+#define WINFETCH_MODULE_OS       ((WINFETCH_ENABLED_MODULES >> 0) & 1)
+#define WINFETCH_MODULE_CPU      ((WINFETCH_ENABLED_MODULES >> 1) & 1)
+#define WINFETCH_MODULE_MEMORY   ((WINFETCH_ENABLED_MODULES >> 2) & 1)
+#define WINFETCH_MODULE_FIRMWARE ((WINFETCH_ENABLED_MODULES >> 3) & 1)
+#define WINFETCH_MODULE_GPU      ((WINFETCH_ENABLED_MODULES >> 4) & 1)
+#define WINFETCH_MODULE_STORAGE  ((WINFETCH_ENABLED_MODULES >> 5) & 1)
+#define WINFETCH_MODULE_NETWORK  ((WINFETCH_ENABLED_MODULES >> 6) & 1)
+#define WINFETCH_MODULE_UPTIME   ((WINFETCH_ENABLED_MODULES >> 7) & 1)
+#define WINFETCH_MODULE_WINDOWS  ((WINFETCH_ENABLED_MODULES >> 8) & 1)
+#define WINFETCH_MODULE_PACKAGES ((WINFETCH_ENABLED_MODULES >> 9) & 1)
+
+struct ModuleInfo {
+    CollectorId id;
+    const char* name;           // As used in WINFETCH_MODULES
+};
+
+// Every module winfetch knows about, in CollectorId order
+constexpr ModuleInfo MODULE_REGISTRY[] = {
+    { COLLECT_OS, "os" },
+    { COLLECT_CPU, "cpu" },
+    { COLLECT_MEMORY, "memory" },
+    { COLLECT_FIRMWARE, "firmware" },
+    { COLLECT_GPU, "gpu" },
+    { COLLECT_STORAGE, "storage" },
+    { COLLECT_NETWORK, "network" },
+    { COLLECT_UPTIME, "uptime" },
+    { COLLECT_WINDOWS, "windows" },
+    { COLLECT_PACKAGES, "packages" },
+};
+
+constexpr unsigned MODULE_COUNT = sizeof(MODULE_REGISTRY) / sizeof(MODULE_REGISTRY[0]);
+constexpr unsigned ENABLED_MODULES = WINFETCH_ENABLED_MODULES & COLLECT_ALL;
+
+constexpr bool moduleEnabled(unsigned id) {
+    return (ENABLED_MODULES & id) == id;
+}
+
+constexpr bool namesEqual(const char* a, const char* b) {
+    return *a == *b && (*a == '\0' || namesEqual(a + 1, b + 1));
+}
+
+// Module id for a name, 0 when unknown; usable in constant expressions
+constexpr unsigned moduleId(const char* name, unsigned index = 0) {
+    return index == MODULE_COUNT ? 0u :
+        namesEqual(MODULE_REGISTRY[index].name, name) ? static_cast<unsigned>(MODULE_REGISTRY[index].id) :
+        moduleId(name, index + 1);
+}
+
+constexpr bool registryInIdOrder(unsigned index = 0) {
+    return index == MODULE_COUNT ||
+        (MODULE_REGISTRY[index].id == (1u << index) && registryInIdOrder(index + 1));
+}
+
+static_assert(registryInIdOrder(), "MODULE_REGISTRY must list modules in CollectorId bit order");
+static_assert(COLLECT_ALL == (1u << MODULE_COUNT) - 1, "every collector needs a MODULE_REGISTRY entry");
+static_assert(moduleId("cpu") == COLLECT_CPU && moduleId("packages") == COLLECT_PACKAGES, "moduleId lookup");
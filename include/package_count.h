@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Installed package count for one package database
+struct PackageCount {
+    std::string source;         // "registry", "dpkg", "rpm", "flatpak"
+    unsigned long long count = 0;
+};
+
+// Counts installed packages per source. Each count is cached together
+// with the modification time of its database, so an unchanged database
+// costs one stat (or one registry key query) instead of a full scan.
+class PackageCounter {
+public:
+    static std::vector<PackageCount> countAll();
+
+    // Scanners over an in-memory copy of a database, usable on captured files
+    static unsigned long long countDpkgStatus(const char* data, size_t size);
+    static unsigned long long countSqliteTableRows(const char* data, size_t size, const std::string& table);
+};
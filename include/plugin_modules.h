@@ -0,0 +1,63 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include "config.h"
+#include "result_cache.h"
+
+// Result of one user-defined module, ready for display
+struct ModuleResult {
+    std::string name;
+    std::string label;
+    std::string value;
+    bool fromCache = false;
+    bool timedOut = false;
+};
+
+// A user-defined module declared in the config file as
+//   module.<name>.command=...   (external command, first output line is used)
+//   module.<name>.library=...   (collector library, see winfetch_plugin.h)
+//   module.<name>.label=...     (defaults to <name>)
+//   module.<name>.ttl=...       (seconds to reuse the last value, 0 = always run)
+struct PluginModule {
+    std::string name;
+    std::string label;
+    std::string command;
+    std::string library;
+    long long ttlSeconds = 0;
+};
+
+// Runs custom modules on background threads so they overlap with the
+// built-in collectors. start() returns immediately; collect() waits for the
+// modules until the shared deadline and kills or abandons the stragglers.
+class PluginRunner {
+public:
+    explicit PluginRunner(const Config& config);
+    ~PluginRunner();
+
+    PluginRunner(const PluginRunner&) = delete;
+    PluginRunner& operator=(const PluginRunner&) = delete;
+
+    void start();
+    std::vector<ModuleResult> collect();
+
+    bool empty() const { return modules.empty(); }
+
+private:
+    struct Slot;
+
+    static std::vector<PluginModule> parseModules(const Config& config);
+    static std::string cacheKey(const PluginModule& module);
+    static void runModule(const PluginModule& module, std::shared_ptr<Slot> slot);
+    static bool runCommand(const std::string& command, std::shared_ptr<Slot> slot, std::string& output);
+    static bool runLibrary(const PluginModule& module, std::string& output);
+
+    std::vector<PluginModule> modules;
+    std::vector<std::shared_ptr<Slot>> slots;
+    std::chrono::milliseconds timeout;
+    std::chrono::steady_clock::time_point deadline;
+    ResultCache cache;
+    bool started;
+};
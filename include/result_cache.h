@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string>
+
+// On-disk cache for values that are expensive to produce (custom modules,
+// slow OS queries). Each entry is a small file holding the time it was
+// written and the value, so a fresh entry costs one file read.
+class ResultCache {
+public:
+    explicit ResultCache(const std::string& name);
+
+    // Returns true and fills value if an entry exists that is at most
+    // maxAgeSeconds old. A negative maxAgeSeconds accepts any age.
+    bool load(const std::string& key, long long maxAgeSeconds, std::string& value) const;
+    void store(const std::string& key, const std::string& value) const;
+
+    static std::string cacheRoot();
+
+private:
+    std::string pathFor(const std::string& key) const;
+
+    std::string directory;
+};
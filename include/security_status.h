@@ -0,0 +1,85 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include "result_cache.h"
+
+// Raw answers the Windows security section is built from. Fetching them
+// can take seconds, so they are kept apart from the formatting and caching
+// logic, which runs the same against a fake provider on any platform.
+struct ActivationFacts {
+    int status = -1;                // SL_LICENSING_STATUS: 0 unlicensed, 1 licensed, 2 grace, 3 notification
+    unsigned graceMinutes = 0;
+};
+
+struct DefenderFacts {
+    int health = -1;                // WSC_SECURITY_PROVIDER_HEALTH: 0 good, 1 not monitored, 2 poor, 3 snoozed
+    int realTime = -1;              // 1 on, 0 off, -1 unknown (another antivirus)
+    std::string signatureVersion;
+};
+
+struct UpdateFacts {
+    long long lastSearch = 0;       // Unix time of the last successful check, 0 = unknown
+    long long lastInstall = 0;      // Unix time of the last successful install, 0 = unknown
+    bool rebootRequired = false;
+};
+
+class SecurityProvider {
+public:
+    virtual ~SecurityProvider() = default;
+
+    virtual bool queryActivation(ActivationFacts& facts) = 0;
+    virtual bool queryDefender(DefenderFacts& facts) = 0;
+    virtual bool queryUpdates(UpdateFacts& facts) = 0;
+
+    // Software Licensing, Security Center and Windows Update Agent APIs,
+    // all called in-process (no slmgr or PowerShell)
+    static std::shared_ptr<SecurityProvider> system();
+};
+
+struct SecurityReport {
+    std::string activation = "Unknown";
+    std::string defender = "Unknown";
+    std::string update = "Unknown";
+};
+
+// Runs the three security queries on background threads, like
+// PluginRunner does for custom modules. Facts younger than their TTL come
+// from the cache without querying; a query that misses the deadline keeps
+// running and caches its answer for the next run, while this one shows
+// the last known value. Tests pass a fake provider and their own cache,
+// or none.
+class SecurityRunner {
+public:
+    explicit SecurityRunner(std::shared_ptr<SecurityProvider> provider,
+                            std::chrono::milliseconds timeout = std::chrono::milliseconds(3000),
+                            std::shared_ptr<const ResultCache> cache = systemCache());
+    ~SecurityRunner();
+
+    SecurityRunner(const SecurityRunner&) = delete;
+    SecurityRunner& operator=(const SecurityRunner&) = delete;
+
+    void start();
+    SecurityReport collect();
+
+    // The on-disk "security" cache, or none while DataProvider records or
+    // replays: a capture must see every query, and a replay must not
+    // overwrite this machine's cached answers
+    static std::shared_ptr<const ResultCache> systemCache();
+
+    static std::string formatActivation(const ActivationFacts& facts);
+    static std::string formatDefender(const DefenderFacts& facts);
+    static std::string formatUpdates(const UpdateFacts& facts, long long now);
+
+private:
+    struct Slot;
+
+    std::shared_ptr<SecurityProvider> provider;
+    std::vector<std::shared_ptr<Slot>> slots;
+    std::chrono::milliseconds timeout;
+    std::chrono::steady_clock::time_point deadline;
+    std::shared_ptr<const ResultCache> cache;   // Null = always query
+    bool started;
+};
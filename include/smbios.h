@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// One populated memory slot (SMBIOS type 17)
+struct SmbiosMemoryDevice {
+    std::string_view deviceLocator;
+    std::string_view bankLocator;
+    std::string_view manufacturer;
+    std::string_view partNumber;
+    const char* type = "Unknown";
+    uint64_t sizeBytes = 0;
+    uint32_t speedMTs = 0;
+    uint32_t configuredSpeedMTs = 0;
+};
+
+// BIOS information (SMBIOS type 0)
+struct SmbiosBios {
+    std::string_view vendor;
+    std::string_view version;
+    std::string_view releaseDate;
+};
+
+// Baseboard information (SMBIOS type 2)
+struct SmbiosBoard {
+    std::string_view manufacturer;
+    std::string_view product;
+    std::string_view version;
+};
+
+// System enclosure information (SMBIOS type 3)
+struct SmbiosChassis {
+    std::string_view manufacturer;
+    const char* type = "Unknown";
+};
+
+// Parser for the raw SMBIOS structure table. The table is read once and
+// kept in a single buffer; all strings handed out are views into it, so
+// the table must outlive them and is move-only.
+class SmbiosTable {
+public:
+    SmbiosTable() = default;
+    SmbiosTable(SmbiosTable&&) = default;
+    SmbiosTable& operator=(SmbiosTable&&) = default;
+    SmbiosTable(const SmbiosTable&) = delete;
+    SmbiosTable& operator=(const SmbiosTable&) = delete;
+
+    // Reads the live table (GetSystemFirmwareTable('RSMB') on Windows,
+    // /sys/firmware/dmi/tables/DMI on Linux)
+    static SmbiosTable loadFromFirmware();
+
+    // Reads a captured dump: either a raw DMI table or a Windows RSMB blob
+    static SmbiosTable loadFromFile(const std::string& path);
+
+    // Takes ownership of a table buffer; the structures start at offset
+    static SmbiosTable fromBuffer(std::vector<uint8_t> buffer, size_t offset, uint8_t majorVersion, uint8_t minorVersion);
+
+    bool valid() const { return parsed; }
+    uint8_t majorVersion() const { return major; }
+    uint8_t minorVersion() const { return minor; }
+
+    const SmbiosBios& bios() const { return biosInfo; }
+    const SmbiosBoard& board() const { return boardInfo; }
+    const SmbiosChassis& chassis() const { return chassisInfo; }
+    const std::vector<SmbiosMemoryDevice>& memoryDevices() const { return memory; }
+
+private:
+    void parse();
+
+    std::vector<uint8_t> data;
+    size_t tableOffset = 0;
+    uint8_t major = 0;
+    uint8_t minor = 0;
+    bool parsed = false;
+
+    SmbiosBios biosInfo;
+    SmbiosBoard boardInfo;
+    SmbiosChassis chassisInfo;
+    std::vector<SmbiosMemoryDevice> memory;
+};
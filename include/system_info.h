@@ -0,0 +1,124 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+#include "collectors.h"
+#include "plugin_modules.h"
+#include "win32_types.h"
+
+class SecurityRunner;
+
+struct SystemInfo {
+    SystemInfo();
+    explicit SystemInfo(unsigned collectors);
+
+    // OS information
+    std::string osName;
+    std::string osVersion;
+    std::string osBuild;
+    std::string windowsEdition;
+    std::string architecture;
+
+    // CPU information
+    std::string cpuName;
+    std::string cpuCores;
+    std::string cpuThreads;
+    std::string cpuFrequency;
+    std::string cpuCoreTypes;
+    std::string cpuTopology;
+    std::string cpuCache;
+    std::string cpuSignature;
+    std::string cpuFeatures;
+    std::string cpuHypervisor;
+    std::string cpuLimit;           // Container or job CPU limit, empty when unlimited
+    std::string container;
+
+    // Memory information
+    std::string totalMemory;
+    std::string availableMemory;
+    std::string memoryUsage;
+    std::vector<std::string> memoryModules;
+    unsigned long long totalMemoryBytes = 0;
+    unsigned long long availableMemoryBytes = 0;
+    std::string memoryLimit;        // Container or job memory limit, empty when unlimited
+    unsigned long long memoryLimitBytes = 0;
+    std::string memoryCommit;       // "used / limit"
+    std::string memorySwap;         // Page files on Windows, "used / total"
+    std::string memoryCache;        // Cached (standby) and dirty (modified) pages
+    std::string memoryHugePages;
+    std::string memoryPressure;     // Linux PSI stall averages, empty elsewhere
+    unsigned long long commitBytes = 0;
+    unsigned long long commitLimitBytes = 0;
+    unsigned long long swapTotalBytes = 0;
+    unsigned long long swapUsedBytes = 0;
+    unsigned long long cachedBytes = 0;
+    unsigned long long dirtyBytes = 0;
+
+    // GPU information
+    std::string gpuName;
+    std::string gpuDriver;
+    std::string gpuMemory;
+
+    // Firmware information (SMBIOS)
+    std::string boardName;
+    std::string biosVersion;
+    std::string chassisType;
+
+    // Storage information
+    std::vector<std::string> drives;
+    std::vector<std::string> driveSizes;
+    std::vector<std::string> driveFree;
+    std::vector<unsigned long long> driveSizeBytes;
+    std::vector<unsigned long long> driveFreeBytes;
+
+    // Installed packages, e.g. "1234 (registry)"
+    std::string packages;
+    std::vector<std::pair<std::string, unsigned long long>> packageCounts;
+
+    // Network information
+    std::string hostname;
+    std::string username;
+    std::string domain;
+
+    // Uptime and locale information
+    std::string uptime;
+    unsigned long long uptimeSeconds = 0;
+    std::string timezone;
+    std::string language;
+
+    // Windows specific information
+    std::string windowsActivation;
+    std::string windowsDefender;
+    std::string windowsUpdate;
+
+    // User-defined modules from the config file
+    std::vector<ModuleResult> customModules;
+
+    void gatherAllInfo();
+    void refresh(unsigned collectors);
+
+    // Flat key/value view of the selected collectors, used for --json
+    // and the C API
+    std::vector<std::pair<std::string, std::string>> toKeyValues(unsigned collectors) const;
+    // Collectors of modules left out of the build (WINFETCH_MODULES) do nothing
+    void gatherOSInfo();
+    void gatherCPUInfo();
+    void gatherMemoryInfo();
+    void gatherFirmwareInfo();
+    void gatherGPUInfo();
+    void gatherStorageInfo();
+    void gatherNetworkInfo();
+    void gatherUptimeInfo();
+    void gatherWindowsInfo();
+    void gatherPackageInfo();
+    void gatherContainerInfo();
+
+private:
+    void gatherWindowsInfo(SecurityRunner& security);
+    std::string executeCommand(const std::string& command);
+    std::string getRegistryValue(HKEY hKey, const std::string& subKey, const std::string& valueName);
+    std::string formatBytes(DWORDLONG bytes);
+    std::string formatUptime(ULONGLONG uptimeMs);
+    std::vector<std::string> splitString(const std::string& str, char delimiter);
+};
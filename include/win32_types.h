@@ -0,0 +1,105 @@
+#pragma once
+
+// Win32 types the collectors pass through DataProvider. On Windows they
+// come from <windows.h>. Elsewhere the live calls are not available, but a
+// capture recorded on 64-bit Windows can still be replayed, so the structs
+// it stores are declared here with the same fields and layout.
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cstdint>
+#include <cstring>
+
+typedef uint8_t BYTE;
+typedef uint16_t WORD;
+typedef uint32_t DWORD;
+typedef int32_t LONG;
+typedef uint64_t ULONGLONG;
+typedef uint64_t DWORDLONG;
+typedef char CHAR;
+typedef char16_t WCHAR;
+typedef struct HKEY__* HKEY;
+
+#define HKEY_CURRENT_USER (reinterpret_cast<HKEY>(static_cast<uintptr_t>(0x80000001)))
+#define HKEY_LOCAL_MACHINE (reinterpret_cast<HKEY>(static_cast<uintptr_t>(0x80000002)))
+
+#define ZeroMemory(destination, length) std::memset((destination), 0, (length))
+
+const BYTE VER_NT_WORKSTATION = 1;
+
+const WORD PROCESSOR_ARCHITECTURE_INTEL = 0;
+const WORD PROCESSOR_ARCHITECTURE_ARM = 5;
+const WORD PROCESSOR_ARCHITECTURE_IA64 = 6;
+const WORD PROCESSOR_ARCHITECTURE_AMD64 = 9;
+const WORD PROCESSOR_ARCHITECTURE_ARM64 = 12;
+const WORD PROCESSOR_ARCHITECTURE_UNKNOWN = 0xFFFF;
+
+struct OSVERSIONINFOEX {
+    DWORD dwOSVersionInfoSize;
+    DWORD dwMajorVersion;
+    DWORD dwMinorVersion;
+    DWORD dwBuildNumber;
+    DWORD dwPlatformId;
+    CHAR szCSDVersion[128];
+    WORD wServicePackMajor;
+    WORD wServicePackMinor;
+    WORD wSuiteMask;
+    BYTE wProductType;
+    BYTE wReserved;
+};
+
+struct SYSTEM_INFO {
+    WORD wProcessorArchitecture;
+    WORD wReserved;
+    DWORD dwPageSize;
+    void* lpMinimumApplicationAddress;
+    void* lpMaximumApplicationAddress;
+    uintptr_t dwActiveProcessorMask;
+    DWORD dwNumberOfProcessors;
+    DWORD dwProcessorType;
+    DWORD dwAllocationGranularity;
+    WORD wProcessorLevel;
+    WORD wProcessorRevision;
+};
+
+struct MEMORYSTATUSEX {
+    DWORD dwLength;
+    DWORD dwMemoryLoad;
+    DWORDLONG ullTotalPhys;
+    DWORDLONG ullAvailPhys;
+    DWORDLONG ullTotalPageFile;
+    DWORDLONG ullAvailPageFile;
+    DWORDLONG ullTotalVirtual;
+    DWORDLONG ullAvailVirtual;
+    DWORDLONG ullAvailExtendedVirtual;
+};
+
+union ULARGE_INTEGER {
+    struct {
+        DWORD LowPart;
+        DWORD HighPart;
+    } u;
+    ULONGLONG QuadPart;
+};
+
+struct SYSTEMTIME {
+    WORD wYear;
+    WORD wMonth;
+    WORD wDayOfWeek;
+    WORD wDay;
+    WORD wHour;
+    WORD wMinute;
+    WORD wSecond;
+    WORD wMilliseconds;
+};
+
+struct TIME_ZONE_INFORMATION {
+    LONG Bias;
+    WCHAR StandardName[32];
+    SYSTEMTIME StandardDate;
+    LONG StandardBias;
+    WCHAR DaylightName[32];
+    SYSTEMTIME DaylightDate;
+    LONG DaylightBias;
+};
+#endif
@@ -0,0 +1,104 @@
+/*
+ * libwinfetch - embeddable system information collection
+ *
+ * Stable C interface to the winfetch collectors. One handle can serve any
+ * number of queries, from any thread; static facts (OS, CPU, firmware, GPU,
+ * host names) are collected once per handle and reused, dynamic ones
+ * (memory, storage, uptime, security) are collected on every query.
+ *
+ *     winfetch_handle* h = winfetch_open(NULL);
+ *     winfetch_result* r = winfetch_query(h, WINFETCH_FIELD_CPU | WINFETCH_FIELD_MEMORY);
+ *     for (size_t i = 0; i < winfetch_result_count(r); i++)
+ *         printf("%s=%s\n", winfetch_result_key(r, i), winfetch_result_value(r, i));
+ *     winfetch_result_free(r);
+ *     winfetch_close(h);
+ */
+#ifndef WINFETCH_H
+#define WINFETCH_H
+
+#include <stddef.h>
+
+#if defined(_WIN32) && defined(WINFETCH_SHARED)
+#ifdef WINFETCH_BUILDING_LIBRARY
+#define WINFETCH_API __declspec(dllexport)
+#else
+#define WINFETCH_API __declspec(dllimport)
+#endif
+#elif defined(WINFETCH_SHARED)
+#define WINFETCH_API __attribute__((visibility("default")))
+#else
+#define WINFETCH_API
+#endif
+
+#define WINFETCH_API_VERSION 1
+
+/* Field groups; the same bits as the collectors in collectors.h */
+#define WINFETCH_FIELD_OS        (1u << 0)
+#define WINFETCH_FIELD_CPU       (1u << 1)
+#define WINFETCH_FIELD_MEMORY    (1u << 2)
+#define WINFETCH_FIELD_FIRMWARE  (1u << 3)
+#define WINFETCH_FIELD_GPU       (1u << 4)
+#define WINFETCH_FIELD_STORAGE   (1u << 5)
+#define WINFETCH_FIELD_NETWORK   (1u << 6)
+#define WINFETCH_FIELD_UPTIME    (1u << 7)
+#define WINFETCH_FIELD_WINDOWS   (1u << 8)
+#define WINFETCH_FIELD_PACKAGES  (1u << 9)
+#define WINFETCH_FIELD_CUSTOM    (1u << 16)  /* Modules from the config file */
+#define WINFETCH_FIELD_ALL       (((1u << 10) - 1) | WINFETCH_FIELD_CUSTOM)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct winfetch_handle winfetch_handle;
+typedef struct winfetch_result winfetch_result;
+typedef struct winfetch_request winfetch_request;
+
+/* Receives ownership of result; free it with winfetch_result_free(). */
+typedef void (*winfetch_callback)(winfetch_result* result, void* user_data);
+
+WINFETCH_API int winfetch_api_version(void);
+
+/* config_path may be NULL to use the defaults. Returns NULL on failure. */
+WINFETCH_API winfetch_handle* winfetch_open(const char* config_path);
+
+/* Waits for outstanding asynchronous queries, then frees the handle. */
+WINFETCH_API void winfetch_close(winfetch_handle* handle);
+
+/* Forgets cached static facts so the next query collects them again. */
+WINFETCH_API void winfetch_invalidate(winfetch_handle* handle, unsigned fields);
+
+/* Synchronous query. Returns NULL on failure. */
+WINFETCH_API winfetch_result* winfetch_query(winfetch_handle* handle, unsigned fields);
+
+/* Asynchronous query; callback runs on a worker thread. Returns 0 on success. */
+WINFETCH_API int winfetch_query_async(winfetch_handle* handle, unsigned fields,
+                                      winfetch_callback callback, void* user_data);
+
+/* Future-style asynchronous query. */
+WINFETCH_API winfetch_request* winfetch_query_start(winfetch_handle* handle, unsigned fields);
+
+/*
+ * Waits up to timeout_ms for the request (0 polls). Returns the result,
+ * which the caller then owns, or NULL if it is not ready yet. Each
+ * request yields its result once.
+ */
+WINFETCH_API winfetch_result* winfetch_request_wait(winfetch_request* request, unsigned timeout_ms);
+
+/* Frees a request, waiting for it to finish if it is still running. */
+WINFETCH_API void winfetch_request_free(winfetch_request* request);
+
+WINFETCH_API size_t winfetch_result_count(const winfetch_result* result);
+WINFETCH_API const char* winfetch_result_key(const winfetch_result* result, size_t index);
+WINFETCH_API const char* winfetch_result_value(const winfetch_result* result, size_t index);
+
+/* Value for key, or NULL if the result has no such key. */
+WINFETCH_API const char* winfetch_result_get(const winfetch_result* result, const char* key);
+
+WINFETCH_API void winfetch_result_free(winfetch_result* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WINFETCH_H */
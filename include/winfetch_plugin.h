@@ -0,0 +1,46 @@
+/*
+ * Winfetch collector plugin ABI
+ *
+ * A collector library is a DLL (or shared object) that exports the two
+ * functions below with C linkage. Winfetch loads it once per run, calls
+ * winfetch_plugin_collect() on a worker thread and prints whatever it
+ * writes into the buffer as the module's value.
+ *
+ * Declare it in winfetch.conf:
+ *
+ *     module.oncall.label=On-call
+ *     module.oncall.library=C:\plugins\oncall.dll
+ *     module.oncall.ttl=300
+ */
+#ifndef WINFETCH_PLUGIN_H
+#define WINFETCH_PLUGIN_H
+
+#include <stddef.h>
+
+#ifdef _WIN32
+#define WINFETCH_PLUGIN_EXPORT __declspec(dllexport)
+#else
+#define WINFETCH_PLUGIN_EXPORT __attribute__((visibility("default")))
+#endif
+
+#define WINFETCH_PLUGIN_ABI_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Must return WINFETCH_PLUGIN_ABI_VERSION. */
+typedef int (*winfetch_plugin_abi_version_fn)(void);
+
+/*
+ * Writes a NUL-terminated UTF-8 value of at most buffer_size bytes into
+ * buffer. module_name is the name used in the config, so one library can
+ * serve several modules. Returns 0 on success, anything else on failure.
+ */
+typedef int (*winfetch_plugin_collect_fn)(const char* module_name, char* buffer, size_t buffer_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WINFETCH_PLUGIN_H */
@@ -0,0 +1,234 @@
+#include "archive_cli.h"
+#include "fleet_archive.h"
+#include "mapped_file.h"
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Parsed snapshots are held for this many files at a time before they
+// are added to the archive
+const size_t FILES_PER_BATCH = 4096;
+
+void printArchiveUsage() {
+    std::cout << "Usage: winfetch archive <output> <snapshot file or directory>...\n\n";
+    std::cout << "Collects winfetch --json snapshots (one per file, or one per line) into\n";
+    std::cout << "a columnar archive for winfetch query. Directories are searched for\n";
+    std::cout << ".json, .jsonl and .ndjson files.\n";
+}
+
+void printQueryUsage() {
+    std::cout << "Usage: winfetch query <archive> [--where <filter>]... [action]\n\n";
+    std::cout << "Filters:\n";
+    std::cout << "  column=value, column!=value, column~text (contains), column<number,\n";
+    std::cout << "  <=, >, >= and ratios such as drive.C:.free_bytes/drive.C:.size_bytes<10%\n\n";
+    std::cout << "Actions (default: count matching snapshots):\n";
+    std::cout << "  --count-by <column>     Matching snapshots per value, most common first\n";
+    std::cout << "  --histogram <column>    Distribution of a numeric column\n";
+    std::cout << "  --buckets <n>           Histogram buckets (default 10)\n";
+    std::cout << "  --list <column>         The column's value for every match\n";
+    std::cout << "  --columns               Columns in the archive\n";
+}
+
+bool isSnapshotFile(const std::filesystem::path& path) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    return extension == ".json" || extension == ".jsonl" || extension == ".ndjson";
+}
+
+std::vector<std::string> collectInputs(int argc, char* argv[]) {
+    std::vector<std::string> files;
+    for (int i = 0; i < argc; i++) {
+        std::error_code ec;
+        if (!std::filesystem::is_directory(argv[i], ec)) {
+            files.push_back(argv[i]);
+            continue;
+        }
+        
+        std::vector<std::string> found;
+        for (auto it = std::filesystem::recursive_directory_iterator(argv[i], ec);
+             !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+            if (it->is_regular_file(ec) && isSnapshotFile(it->path())) {
+                found.push_back(it->path().string());
+            }
+        }
+        // Directory order is arbitrary; rows follow file names
+        std::sort(found.begin(), found.end());
+        files.insert(files.end(), found.begin(), found.end());
+    }
+    return files;
+}
+
+}
+
+int runArchiveCommand(int argc, char* argv[]) {
+    if (argc < 2 || std::string(argv[0]) == "-h" || std::string(argv[0]) == "--help") {
+        printArchiveUsage();
+        return argc < 2 ? 1 : 0;
+    }
+    
+    std::string output = argv[0];
+    std::vector<std::string> files = collectInputs(argc - 1, argv + 1);
+    ArchiveWriter writer;
+    size_t skipped = 0;
+    
+    // Files are parsed in parallel; adding them stays in file order
+    for (size_t first = 0; first < files.size(); first += FILES_PER_BATCH) {
+        size_t count = std::min(FILES_PER_BATCH, files.size() - first);
+        std::vector<std::vector<ArchiveWriter::Snapshot>> parsed(count);
+        std::vector<char> readable(count, 0);
+        std::atomic<size_t> next(0);
+        auto work = [&]() {
+            for (size_t i = next++; i < count; i = next++) {
+                MappedFile file(files[first + i]);
+                if (file.valid()) {
+                    readable[i] = 1;
+                    ArchiveWriter::parseSnapshots(std::string_view(file.data(), file.size()), parsed[i]);
+                }
+            }
+        };
+        
+        unsigned workers = static_cast<unsigned>(std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), count));
+        std::vector<std::thread> threads;
+        for (unsigned i = 1; i < workers; i++) {
+            threads.emplace_back(work);
+        }
+        work();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        
+        for (size_t i = 0; i < count; i++) {
+            if (!readable[i] || parsed[i].empty()) {
+                std::cerr << "Warning: no snapshots in " << files[first + i] << "\n";
+                skipped++;
+                continue;
+            }
+            for (const auto& snapshot : parsed[i]) {
+                writer.add(snapshot);
+            }
+        }
+    }
+    
+    if (writer.rows() == 0) {
+        std::cerr << "Error: no snapshots to archive\n";
+        return 1;
+    }
+    if (!writer.write(output)) {
+        std::cerr << "Error: cannot write " << output << "\n";
+        return 1;
+    }
+    
+    std::cout << "Archived " << writer.rows() << " snapshots from " << files.size() - skipped << " files into "
+              << output << " (" << writer.columnCount() << " columns)\n";
+    return 0;
+}
+
+int runQueryCommand(int argc, char* argv[]) {
+    if (argc < 1 || std::string(argv[0]) == "-h" || std::string(argv[0]) == "--help") {
+        printQueryUsage();
+        return argc < 1 ? 1 : 0;
+    }
+    
+    FleetArchive archive(argv[0]);
+    if (!archive.valid()) {
+        std::cerr << "Error: " << argv[0] << " is not a winfetch archive\n";
+        return 1;
+    }
+    
+    ArchiveQuery query(archive);
+    std::string action;
+    std::string column;
+    unsigned buckets = 10;
+    std::string error;
+    
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool takesValue = arg == "--where" || arg == "--count-by" || arg == "--histogram" || arg == "--list" || arg == "--buckets";
+        if (takesValue && i + 1 >= argc) {
+            std::cerr << "Error: " << arg << " requires a value\n";
+            return 1;
+        }
+        
+        if (arg == "--where") {
+            if (!query.where(argv[++i], error)) {
+                std::cerr << "Error: " << error << "\n";
+                return 1;
+            }
+        }
+        else if (arg == "--buckets") {
+            buckets = static_cast<unsigned>(std::max(1, std::atoi(argv[++i])));
+        }
+        else if (arg == "--count-by" || arg == "--histogram" || arg == "--list" || arg == "--columns") {
+            if (!action.empty()) {
+                std::cerr << "Error: " << action << " and " << arg << " cannot be combined\n";
+                return 1;
+            }
+            action = arg;
+            if (takesValue) {
+                column = argv[++i];
+            }
+        }
+        else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            printQueryUsage();
+            return 1;
+        }
+    }
+    
+    if (action == "--columns") {
+        for (const auto& entry : archive.columns()) {
+            std::cout << entry.name << "\t" << (entry.numeric ? "number" : "text") << "\t" << entry.width << " bytes";
+            if (!entry.numeric) {
+                std::cout << "\t" << entry.dictionarySize << " distinct";
+            }
+            std::cout << "\n";
+        }
+    }
+    else if (action == "--count-by") {
+        auto counts = query.countBy(column, error);
+        if (!error.empty()) {
+            std::cerr << "Error: " << error << "\n";
+            return 1;
+        }
+        for (const auto& entry : counts) {
+            std::cout << std::setw(10) << entry.second << "  " << entry.first << "\n";
+        }
+    }
+    else if (action == "--histogram") {
+        auto histogram = query.histogram(column, buckets, error);
+        if (!error.empty()) {
+            std::cerr << "Error: " << error << "\n";
+            return 1;
+        }
+        uint64_t largest = 0;
+        for (const auto& bucket : histogram) {
+            largest = std::max(largest, bucket.count);
+        }
+        for (const auto& bucket : histogram) {
+            size_t bar = largest ? static_cast<size_t>(bucket.count * 40 / largest) : 0;
+            std::cout << std::fixed << std::setprecision(0) << std::setw(16) << bucket.low << " - " << std::setw(16) << bucket.high
+                      << std::setw(10) << bucket.count << "  " << std::string(bar, '#') << "\n";
+        }
+    }
+    else if (action == "--list") {
+        auto values = query.list(column, error);
+        if (!error.empty()) {
+            std::cerr << "Error: " << error << "\n";
+            return 1;
+        }
+        for (const auto& value : values) {
+            std::cout << value << "\n";
+        }
+    }
+    else {
+        std::cout << query.count() << " of " << archive.rows() << " snapshots\n";
+    }
+    return 0;
+}
@@ -0,0 +1,419 @@
+#include "batch_reader.h"
+#include "data_provider.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define WINFETCH_HAVE_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+#ifdef WINFETCH_HAVE_IO_URING
+
+namespace {
+
+// Set once io_uring_setup fails (old kernel, seccomp, container policy) so
+// later readers go straight to the thread pool
+std::atomic<bool> ioUringUnavailable(false);
+
+const unsigned RING_ENTRIES = 256;
+
+}
+
+// Minimal io_uring driver over the raw syscalls, so there is no liburing
+// dependency. Each batch is submitted with one io_uring_enter that also
+// waits for all of its completions.
+struct BatchReader::Ring {
+    int fd = -1;
+    unsigned entries = 0;
+    
+    void* sqRing = MAP_FAILED;
+    size_t sqRingSize = 0;
+    void* cqRing = MAP_FAILED;
+    size_t cqRingSize = 0;
+    io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    size_t sqesSize = 0;
+    
+    unsigned* sqTail = nullptr;
+    unsigned* sqMask = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned* cqMask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+    
+    bool init(unsigned requested) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        fd = static_cast<int>(syscall(__NR_io_uring_setup, requested, &params));
+        if (fd < 0) {
+            return false;
+        }
+        entries = params.sq_entries;
+        
+        sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMap) {
+            sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+        }
+        
+        sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (sqRing == MAP_FAILED) {
+            return false;
+        }
+        if (singleMap) {
+            cqRing = sqRing;
+        } else {
+            cqRing = mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+            if (cqRing == MAP_FAILED) {
+                return false;
+            }
+        }
+        
+        sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqeMap = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if (sqeMap == MAP_FAILED) {
+            return false;
+        }
+        sqes = static_cast<io_uring_sqe*>(sqeMap);
+        
+        char* sq = static_cast<char*>(sqRing);
+        char* cq = static_cast<char*>(cqRing);
+        sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return true;
+    }
+    
+    ~Ring() {
+        if (sqes != MAP_FAILED) munmap(sqes, sqesSize);
+        if (cqRing != MAP_FAILED && cqRing != sqRing) munmap(cqRing, cqRingSize);
+        if (sqRing != MAP_FAILED) munmap(sqRing, sqRingSize);
+        if (fd >= 0) close(fd);
+    }
+    
+    // Fills count SQEs through prepare(sqe, i), submits them and hands
+    // every completion to complete(i, result)
+    template <typename Prepare, typename Complete>
+    bool submitAndWait(unsigned count, Prepare prepare, Complete complete) {
+        unsigned tail = *sqTail;
+        for (unsigned i = 0; i < count; i++) {
+            unsigned slot = (tail + i) & *sqMask;
+            io_uring_sqe* sqe = &sqes[slot];
+            std::memset(sqe, 0, sizeof(*sqe));
+            prepare(sqe, i);
+            sqe->user_data = i;
+            sqArray[slot] = slot;
+        }
+        __atomic_store_n(sqTail, tail + count, __ATOMIC_RELEASE);
+        
+        unsigned submitted = 0;
+        unsigned reaped = 0;
+        while (reaped < count) {
+            int ret = static_cast<int>(syscall(__NR_io_uring_enter, fd, count - submitted,
+                                               count - reaped, IORING_ENTER_GETEVENTS, nullptr, 0));
+            if (ret < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            submitted += static_cast<unsigned>(ret);
+            
+            unsigned head = *cqHead;
+            unsigned ready = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+            for (; head != ready; head++) {
+                const io_uring_cqe& cqe = cqes[head & *cqMask];
+                complete(static_cast<unsigned>(cqe.user_data), cqe.res);
+                reaped++;
+            }
+            __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+        }
+        return true;
+    }
+};
+
+#else
+
+struct BatchReader::Ring {
+};
+
+#endif
+
+BatchReader::BatchReader(size_t defaultCapacity) : defaultCapacity(defaultCapacity) {
+}
+
+BatchReader::~BatchReader() = default;
+
+size_t BatchReader::add(const std::string& path, size_t capacity) {
+    Request request;
+    request.path = path;
+    request.offset = poolSize;
+    request.capacity = capacity ? capacity : defaultCapacity;
+    poolSize += request.capacity;
+    requests.push_back(std::move(request));
+    return requests.size() - 1;
+}
+
+void BatchReader::clear() {
+    requests.clear();
+    poolSize = 0;
+}
+
+std::string_view BatchReader::view(size_t index) const {
+    const Request& request = requests[index];
+    if (request.length <= 0) {
+        return std::string_view();
+    }
+    return std::string_view(pool.data() + request.offset, static_cast<size_t>(request.length));
+}
+
+std::string_view BatchReader::firstLine(size_t index) const {
+    std::string_view text = view(index);
+    size_t newline = text.find('\n');
+    if (newline != std::string_view::npos) {
+        text = text.substr(0, newline);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+void BatchReader::run() {
+    // One allocation for the whole pass; it only grows across passes
+    if (pool.size() < poolSize) {
+        pool.resize(poolSize);
+    }
+    for (auto& request : requests) {
+        request.length = -1;
+        request.fd = -1;
+    }
+    
+    // Recorded and replayed runs need every answer to go through the
+    // provider, one file at a time
+    DataProvider& provider = DataProvider::instance();
+    if (provider.recording() || provider.replaying()) {
+        runProvider();
+        usedBackend = "provider";
+        return;
+    }
+    
+    if (runIoUring()) {
+        usedBackend = "io_uring";
+        return;
+    }
+    runThreadPool();
+    usedBackend = "threads";
+}
+
+bool BatchReader::runIoUring() {
+#ifdef WINFETCH_HAVE_IO_URING
+    if (requests.empty() || ioUringUnavailable.load(std::memory_order_relaxed)) {
+        return false;
+    }
+    
+    if (!ring) {
+        std::unique_ptr<Ring> created(new Ring());
+        if (!created->init(RING_ENTRIES)) {
+            ioUringUnavailable.store(true, std::memory_order_relaxed);
+            return false;
+        }
+        ring = std::move(created);
+    }
+    
+    // Open, read and close each run as their own batches; a read cannot
+    // name a descriptor that is only returned by an open in the same batch
+    bool supported = true;
+    for (size_t first = 0; first < requests.size(); first += ring->entries) {
+        unsigned count = static_cast<unsigned>(std::min<size_t>(ring->entries, requests.size() - first));
+        Request* batch = requests.data() + first;
+        
+        bool ok = ring->submitAndWait(count, [batch](io_uring_sqe* sqe, unsigned i) {
+            sqe->opcode = IORING_OP_OPENAT;
+            sqe->fd = AT_FDCWD;
+            sqe->addr = reinterpret_cast<uint64_t>(batch[i].path.c_str());
+            sqe->open_flags = O_RDONLY | O_CLOEXEC;
+        }, [batch, &supported](unsigned i, int result) {
+            // Kernels before 5.6 reject the opcode itself
+            if (result == -EINVAL) {
+                supported = false;
+            }
+            batch[i].fd = result >= 0 ? result : -1;
+        });
+        
+        if (ok && supported) {
+            char* buffer = pool.data();
+            ok = ring->submitAndWait(count, [batch, buffer](io_uring_sqe* sqe, unsigned i) {
+                if (batch[i].fd < 0) {
+                    sqe->opcode = IORING_OP_NOP;
+                    return;
+                }
+                sqe->opcode = IORING_OP_READ;
+                sqe->fd = batch[i].fd;
+                sqe->addr = reinterpret_cast<uint64_t>(buffer + batch[i].offset);
+                sqe->len = static_cast<uint32_t>(batch[i].capacity);
+                sqe->off = 0;
+            }, [batch](unsigned i, int result) {
+                if (batch[i].fd >= 0) {
+                    batch[i].length = result >= 0 ? result : -1;
+                }
+            });
+        }
+        
+        // procfs seq files (mountinfo, meminfo on big hosts) hand out about
+        // a page per read; keep reading the unfinished ones, all together,
+        // until end of file or capacity. A file that has reached its end
+        // stays done, even while others still need another round.
+        std::vector<unsigned> pending;
+        std::vector<char> done(count, 0);
+        auto collectPending = [batch, count, &pending, &done]() {
+            pending.clear();
+            for (unsigned i = 0; i < count; i++) {
+                if (!done[i] && batch[i].fd >= 0 && batch[i].length > 0 && static_cast<size_t>(batch[i].length) < batch[i].capacity) {
+                    pending.push_back(i);
+                }
+            }
+        };
+        collectPending();
+        while (ok && supported && !pending.empty()) {
+            char* buffer = pool.data();
+            ok = ring->submitAndWait(static_cast<unsigned>(pending.size()), [batch, buffer, &pending](io_uring_sqe* sqe, unsigned j) {
+                Request& request = batch[pending[j]];
+                sqe->opcode = IORING_OP_READ;
+                sqe->fd = request.fd;
+                sqe->addr = reinterpret_cast<uint64_t>(buffer + request.offset + request.length);
+                sqe->len = static_cast<uint32_t>(request.capacity - static_cast<size_t>(request.length));
+                sqe->off = static_cast<uint64_t>(request.length);
+            }, [batch, &pending, &done](unsigned j, int result) {
+                if (result > 0) {
+                    batch[pending[j]].length += result;
+                } else {
+                    done[pending[j]] = 1;
+                }
+            });
+            collectPending();
+        }
+        
+        // Descriptors are closed even when a batch failed halfway
+        ok = ok && supported;
+        for (unsigned i = 0; i < count && !ok; i++) {
+            if (batch[i].fd >= 0) {
+                close(batch[i].fd);
+                batch[i].fd = -1;
+            }
+        }
+        if (ok) {
+            ring->submitAndWait(count, [batch](io_uring_sqe* sqe, unsigned i) {
+                sqe->opcode = batch[i].fd >= 0 ? IORING_OP_CLOSE : IORING_OP_NOP;
+                sqe->fd = batch[i].fd;
+            }, [batch](unsigned i, int) {
+                batch[i].fd = -1;
+            });
+        }
+        
+        if (!ok) {
+            ioUringUnavailable.store(true, std::memory_order_relaxed);
+            ring.reset();
+            for (auto& request : requests) {
+                request.length = -1;
+            }
+            return false;
+        }
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void BatchReader::readOne(Request& request) {
+    char* buffer = pool.data() + request.offset;
+#ifdef _WIN32
+    FILE* file = fopen(request.path.c_str(), "rb");
+    if (!file) {
+        return;
+    }
+    request.length = static_cast<long long>(fread(buffer, 1, request.capacity, file));
+    fclose(file);
+#else
+    int fd = open(request.path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+    // Until end of file: procfs seq files return about a page per read
+    size_t total = 0;
+    while (total < request.capacity) {
+        ssize_t length = read(fd, buffer + total, request.capacity - total);
+        if (length < 0 && errno == EINTR) {
+            continue;
+        }
+        if (length <= 0) {
+            if (length < 0 && total == 0) {
+                request.length = -1;
+                close(fd);
+                return;
+            }
+            break;
+        }
+        total += static_cast<size_t>(length);
+    }
+    request.length = static_cast<long long>(total);
+    close(fd);
+#endif
+}
+
+void BatchReader::runThreadPool() {
+    // Small passes are not worth a thread start
+    const size_t PER_THREAD = 32;
+    unsigned workers = std::max(1u, std::min(std::thread::hardware_concurrency(), 8u));
+    workers = static_cast<unsigned>(std::min<size_t>(workers, (requests.size() + PER_THREAD - 1) / PER_THREAD));
+    
+    std::atomic<size_t> next(0);
+    auto work = [this, &next]() {
+        for (size_t i = next++; i < requests.size(); i = next++) {
+            readOne(requests[i]);
+        }
+    };
+    
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < workers; i++) {
+        threads.emplace_back(work);
+    }
+    work();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void BatchReader::runProvider() {
+    DataProvider& provider = DataProvider::instance();
+    for (auto& request : requests) {
+        std::string content = provider.fetch("file", request.path, [this, &request]() {
+            readOne(request);
+            return request.length > 0 ? std::string(pool.data() + request.offset, static_cast<size_t>(request.length)) : std::string();
+        });
+        
+        size_t length = std::min(content.size(), request.capacity);
+        std::memcpy(pool.data() + request.offset, content.data(), length);
+        request.length = content.empty() ? -1 : static_cast<long long>(length);
+    }
+}
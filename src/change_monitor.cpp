@@ -0,0 +1,334 @@
+#include "change_monitor.h"
+#include "collectors.h"
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <dbt.h>
+#else
+#include <fcntl.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+#ifdef _WIN32
+
+namespace {
+
+const char* WINDOW_CLASS = "WinfetchChangeMonitor";
+
+struct RegistryWatch {
+    HKEY key;
+    HANDLE event;
+    BOOL subtree;
+    unsigned collectors;
+};
+
+// Registry notifications are one-shot and must be re-armed after firing
+bool armRegistryWatch(RegistryWatch& watch) {
+    return RegNotifyChangeKeyValue(watch.key, watch.subtree,
+        REG_NOTIFY_CHANGE_NAME | REG_NOTIFY_CHANGE_LAST_SET,
+        watch.event, TRUE) == ERROR_SUCCESS;
+}
+
+LRESULT CALLBACK monitorWindowProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam) {
+    unsigned* pending = reinterpret_cast<unsigned*>(GetWindowLongPtr(hwnd, GWLP_USERDATA));
+    
+    if (pending) {
+        switch (message) {
+            case WM_DEVICECHANGE:
+                if (wParam == DBT_DEVICEARRIVAL || wParam == DBT_DEVICEREMOVECOMPLETE) {
+                    const DEV_BROADCAST_HDR* header = reinterpret_cast<const DEV_BROADCAST_HDR*>(lParam);
+                    if (header && header->dbch_devicetype == DBT_DEVTYP_VOLUME) {
+                        *pending |= COLLECT_STORAGE;
+                    }
+                }
+                return TRUE;
+            case WM_SETTINGCHANGE:
+            case WM_TIMECHANGE:
+                // Locale and time zone are reported by the uptime collector
+                *pending |= COLLECT_UPTIME;
+                return 0;
+            case WM_DISPLAYCHANGE:
+                *pending |= COLLECT_GPU;
+                return 0;
+            default:
+                break;
+        }
+    }
+    
+    return DefWindowProc(hwnd, message, wParam, lParam);
+}
+
+}
+
+struct ChangeMonitor::Impl {
+    std::vector<RegistryWatch> watches;
+    HWND window = nullptr;
+    unsigned pending = 0;
+    
+    void addRegistryWatch(HKEY root, const char* path, BOOL subtree, unsigned collectors) {
+        RegistryWatch watch;
+        watch.subtree = subtree;
+        watch.collectors = collectors;
+        if (RegOpenKeyEx(root, path, 0, KEY_NOTIFY, &watch.key) != ERROR_SUCCESS) {
+            return;
+        }
+        watch.event = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+        if (!watch.event || !armRegistryWatch(watch)) {
+            if (watch.event) CloseHandle(watch.event);
+            RegCloseKey(watch.key);
+            return;
+        }
+        watches.push_back(watch);
+    }
+    
+    Impl() {
+        addRegistryWatch(HKEY_LOCAL_MACHINE, "SOFTWARE\\Microsoft\\Windows NT\\CurrentVersion", FALSE, COLLECT_OS);
+        addRegistryWatch(HKEY_LOCAL_MACHINE, "SYSTEM\\CurrentControlSet\\Control\\Class\\{4d36e968-e325-11ce-bfc1-08002be10318}", TRUE, COLLECT_GPU);
+        addRegistryWatch(HKEY_LOCAL_MACHINE, "SYSTEM\\CurrentControlSet\\Services\\Tcpip\\Parameters", FALSE, COLLECT_NETWORK);
+        addRegistryWatch(HKEY_LOCAL_MACHINE, "SYSTEM\\CurrentControlSet\\Control\\ComputerName\\ActiveComputerName", FALSE, COLLECT_NETWORK);
+        
+        // Volume arrival is only broadcast to top-level windows, so this
+        // is a hidden top-level window rather than a message-only one
+        WNDCLASSA wc;
+        ZeroMemory(&wc, sizeof(wc));
+        wc.lpfnWndProc = monitorWindowProc;
+        wc.hInstance = GetModuleHandle(nullptr);
+        wc.lpszClassName = WINDOW_CLASS;
+        RegisterClassA(&wc);
+        
+        window = CreateWindowExA(0, WINDOW_CLASS, "", 0, 0, 0, 0, 0, nullptr, nullptr, wc.hInstance, nullptr);
+        if (window) {
+            SetWindowLongPtr(window, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(&pending));
+        }
+    }
+    
+    ~Impl() {
+        if (window) {
+            DestroyWindow(window);
+        }
+        for (auto& watch : watches) {
+            CloseHandle(watch.event);
+            RegCloseKey(watch.key);
+        }
+    }
+    
+    void pumpMessages() {
+        MSG msg;
+        while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE)) {
+            TranslateMessage(&msg);
+            DispatchMessage(&msg);
+        }
+    }
+    
+    unsigned wait(std::chrono::milliseconds timeout) {
+        std::vector<HANDLE> events;
+        for (const auto& watch : watches) {
+            events.push_back(watch.event);
+        }
+        
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (pending == 0) {
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            if (remaining.count() <= 0) {
+                break;
+            }
+            
+            DWORD result = MsgWaitForMultipleObjects(static_cast<DWORD>(events.size()), events.data(),
+                FALSE, static_cast<DWORD>(remaining.count()), QS_ALLINPUT);
+            
+            if (result == WAIT_TIMEOUT) {
+                break;
+            }
+            if (result >= WAIT_OBJECT_0 && result < WAIT_OBJECT_0 + events.size()) {
+                RegistryWatch& watch = watches[result - WAIT_OBJECT_0];
+                pending |= watch.collectors;
+                armRegistryWatch(watch);
+            }
+            pumpMessages();
+        }
+        
+        // Pick up anything else that fired at the same time
+        for (auto& watch : watches) {
+            if (WaitForSingleObject(watch.event, 0) == WAIT_OBJECT_0) {
+                pending |= watch.collectors;
+                armRegistryWatch(watch);
+            }
+        }
+        pumpMessages();
+        
+        unsigned changed = pending;
+        pending = 0;
+        return changed;
+    }
+    
+    bool active() const {
+        return !watches.empty() || window != nullptr;
+    }
+};
+
+#else
+
+namespace {
+
+// Maps a kernel uevent ("action@devpath\0KEY=VALUE\0...") to collectors
+unsigned collectorsForUevent(const char* message, size_t length) {
+    unsigned collectors = 0;
+    const char* p = message;
+    const char* end = message + length;
+    
+    while (p < end) {
+        size_t len = strnlen(p, static_cast<size_t>(end - p));
+        std::string field(p, len);
+        if (field == "SUBSYSTEM=drm") collectors |= COLLECT_GPU;
+        else if (field == "SUBSYSTEM=block") collectors |= COLLECT_STORAGE;
+        else if (field == "SUBSYSTEM=cpu") collectors |= COLLECT_CPU;
+        else if (field == "SUBSYSTEM=memory") collectors |= COLLECT_MEMORY;
+        else if (field == "SUBSYSTEM=net") collectors |= COLLECT_NETWORK;
+        p += len + 1;
+    }
+    
+    return collectors;
+}
+
+unsigned collectorsForEtcFile(const std::string& name) {
+    if (name == "hostname" || name == "hosts") return COLLECT_NETWORK;
+    if (name == "os-release") return COLLECT_OS;
+    if (name == "localtime" || name == "timezone" || name == "locale.conf") return COLLECT_UPTIME;
+    return 0;
+}
+
+}
+
+struct ChangeMonitor::Impl {
+    int mountFd = -1;
+    int ueventFd = -1;
+    int routeFd = -1;
+    int inotifyFd = -1;
+    
+    Impl() {
+        mountFd = open("/proc/self/mountinfo", O_RDONLY | O_CLOEXEC);
+        
+        sockaddr_nl address;
+        std::memset(&address, 0, sizeof(address));
+        address.nl_family = AF_NETLINK;
+        
+        ueventFd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_KOBJECT_UEVENT);
+        address.nl_groups = 1; // Kernel uevent multicast group
+        if (ueventFd >= 0 && bind(ueventFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            close(ueventFd);
+            ueventFd = -1;
+        }
+        
+        routeFd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_ROUTE);
+        address.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR;
+        if (routeFd >= 0 && bind(routeFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            close(routeFd);
+            routeFd = -1;
+        }
+        
+        // Files in /etc are usually replaced by rename, so watch the directory
+        inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotifyFd >= 0 && inotify_add_watch(inotifyFd, "/etc", IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE) < 0) {
+            close(inotifyFd);
+            inotifyFd = -1;
+        }
+    }
+    
+    ~Impl() {
+        for (int fd : { mountFd, ueventFd, routeFd, inotifyFd }) {
+            if (fd >= 0) close(fd);
+        }
+    }
+    
+    // Drains a non-blocking socket, applying f to each datagram
+    template <typename F>
+    void drain(int fd, F f) {
+        char buffer[8192];
+        ssize_t received;
+        while ((received = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+            f(buffer, static_cast<size_t>(received));
+        }
+    }
+    
+    unsigned wait(std::chrono::milliseconds timeout) {
+        std::vector<pollfd> fds;
+        if (mountFd >= 0) fds.push_back({ mountFd, POLLPRI, 0 });
+        if (ueventFd >= 0) fds.push_back({ ueventFd, POLLIN, 0 });
+        if (routeFd >= 0) fds.push_back({ routeFd, POLLIN, 0 });
+        if (inotifyFd >= 0) fds.push_back({ inotifyFd, POLLIN, 0 });
+        
+        unsigned changed = 0;
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        
+        while (changed == 0) {
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            if (remaining.count() <= 0) {
+                break;
+            }
+            
+            int ready = poll(fds.data(), fds.size(), static_cast<int>(remaining.count()));
+            if (ready <= 0) {
+                break;
+            }
+            
+            for (const auto& entry : fds) {
+                if (!entry.revents) continue;
+                
+                if (entry.fd == mountFd) {
+                    // poll() itself acknowledges the mount table event
+                    changed |= COLLECT_STORAGE;
+                } else if (entry.fd == ueventFd) {
+                    drain(ueventFd, [&changed](const char* data, size_t length) {
+                        changed |= collectorsForUevent(data, length);
+                    });
+                } else if (entry.fd == routeFd) {
+                    drain(routeFd, [&changed](const char*, size_t) {
+                        changed |= COLLECT_NETWORK;
+                    });
+                } else if (entry.fd == inotifyFd) {
+                    char buffer[4096] __attribute__((aligned(__alignof__(inotify_event))));
+                    ssize_t length;
+                    while ((length = read(inotifyFd, buffer, sizeof(buffer))) > 0) {
+                        for (char* p = buffer; p < buffer + length; ) {
+                            const inotify_event* event = reinterpret_cast<const inotify_event*>(p);
+                            if (event->len > 0) {
+                                changed |= collectorsForEtcFile(event->name);
+                            }
+                            p += sizeof(inotify_event) + event->len;
+                        }
+                    }
+                }
+            }
+        }
+        
+        return changed;
+    }
+    
+    bool active() const {
+        return mountFd >= 0 || ueventFd >= 0 || routeFd >= 0 || inotifyFd >= 0;
+    }
+};
+
+#endif
+
+ChangeMonitor::ChangeMonitor() : impl(new Impl()) {
+}
+
+ChangeMonitor::~ChangeMonitor() {
+}
+
+bool ChangeMonitor::active() const {
+    return impl->active();
+}
+
+unsigned ChangeMonitor::waitForChanges(std::chrono::milliseconds timeout) {
+    return impl->wait(timeout);
+}
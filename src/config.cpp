@@ -74,3 +74,24 @@ void Config::saveToFile(const std::string& filename) {
     
     file.close();
 }
+
+std::string Config::getSetting(const std::string& key, const std::string& defaultValue) const {
+    auto it = settings.find(key);
+    if (it == settings.end()) {
+        return defaultValue;
+    }
+    return it->second;
+}
+
+int Config::getIntSetting(const std::string& key, int defaultValue) const {
+    auto it = settings.find(key);
+    if (it == settings.end()) {
+        return defaultValue;
+    }
+    
+    try {
+        return std::stoi(it->second);
+    } catch (const std::exception&) {
+        return defaultValue;
+    }
+}
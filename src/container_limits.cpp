@@ -0,0 +1,349 @@
+#include "container_limits.h"
+#include "cpu_topology.h"
+#include "data_provider.h"
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <sstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include "batch_reader.h"
+#endif
+
+namespace {
+
+// cgroup v1 reports "no limit" as a page-rounded LONG_MAX
+const unsigned long long UNLIMITED_THRESHOLD = 1ULL << 60;
+
+struct CgroupMount {
+    std::string root;
+    std::string point;
+    std::string type;
+    std::string options;
+};
+
+std::vector<std::string> splitLines(const std::string& text) {
+    std::vector<std::string> lines;
+    std::istringstream stream(text);
+    std::string line;
+    while (std::getline(stream, line)) {
+        if (!line.empty()) {
+            lines.push_back(line);
+        }
+    }
+    return lines;
+}
+
+bool hasOption(const std::string& options, const std::string& name) {
+    std::istringstream stream(options);
+    std::string option;
+    while (std::getline(stream, option, ',')) {
+        if (option == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// mountinfo: id parent major:minor root mountpoint options [optional...] - type source superoptions
+std::vector<CgroupMount> parseCgroupMounts(const std::vector<std::string>& lines) {
+    std::vector<CgroupMount> mounts;
+    for (const auto& line : lines) {
+        std::istringstream stream(line);
+        std::vector<std::string> fields;
+        std::string field;
+        while (stream >> field) {
+            fields.push_back(field);
+        }
+        
+        auto dash = std::find(fields.begin(), fields.end(), "-");
+        if (fields.size() < 5 || dash == fields.end() || fields.end() - dash < 4) {
+            continue;
+        }
+        
+        CgroupMount mount;
+        mount.root = fields[3];
+        mount.point = fields[4];
+        mount.type = *(dash + 1);
+        mount.options = *(dash + 3);
+        if (mount.type == "cgroup" || mount.type == "cgroup2") {
+            mounts.push_back(mount);
+        }
+    }
+    return mounts;
+}
+
+// The container runtime leaves its name in the cgroup path, or failing
+// that (private cgroup namespace) in the bind mounts it sets up
+std::string detectContainer(const std::string& cgroup, const std::vector<std::string>& mountLines) {
+    if (cgroup.find("kubepods") != std::string::npos) return "kubernetes";
+    if (cgroup.find("libpod") != std::string::npos) return "podman";
+    if (cgroup.find("docker") != std::string::npos) return "docker";
+    if (cgroup.find("lxc.payload") != std::string::npos || cgroup.find("/lxc/") != std::string::npos) return "lxc";
+    if (cgroup.find("systemd-nspawn") != std::string::npos) return "systemd-nspawn";
+    
+    bool overlayRoot = false;
+    for (const auto& line : mountLines) {
+        if (line.find("/kubernetes.io/serviceaccount") != std::string::npos ||
+            line.find("/var/lib/kubelet/pods/") != std::string::npos) {
+            return "kubernetes";
+        }
+        if (line.find(" /run/.containerenv ") != std::string::npos) return "podman";
+        if (line.find("/var/lib/docker/containers/") != std::string::npos) return "docker";
+        if (line.find(" /usr/lib/wsl") != std::string::npos || line.find(" - 9p drvfs ") != std::string::npos) return "wsl";
+        if (line.find(" / / ") != std::string::npos && line.find(" - overlay ") != std::string::npos) {
+            overlayRoot = true;
+        }
+    }
+    return overlayRoot ? "container" : "";
+}
+
+// Directories from the process's own cgroup up to the top of the mount;
+// limits set on any ancestor apply too
+std::vector<std::string> cgroupDirs(const CgroupMount& mount, std::string path, const std::string& root) {
+    if (mount.root != "/" && path.compare(0, mount.root.size(), mount.root) == 0) {
+        path = path.substr(mount.root.size());
+    }
+    
+    std::vector<std::string> dirs;
+    while (!path.empty() && path != "/") {
+        dirs.push_back(root + mount.point + path);
+        path = path.substr(0, path.find_last_of('/'));
+    }
+    dirs.push_back(root + mount.point);
+    return dirs;
+}
+
+unsigned long long parseLimit(const std::string& text) {
+    if (text.empty() || text == "max") {
+        return 0;
+    }
+    unsigned long long value = std::strtoull(text.c_str(), nullptr, 10);
+    return value >= UNLIMITED_THRESHOLD ? 0 : value;
+}
+
+void tightenMemory(ContainerLimits& limits, unsigned long long limit) {
+    if (limit > 0 && (limits.memoryLimitBytes == 0 || limit < limits.memoryLimitBytes)) {
+        limits.memoryLimitBytes = limit;
+    }
+}
+
+void tightenCpu(ContainerLimits& limits, long long quota, long long period) {
+    if (quota > 0 && period > 0) {
+        double cpus = static_cast<double>(quota) / static_cast<double>(period);
+        if (limits.cpuQuota == 0 || cpus < limits.cpuQuota) {
+            limits.cpuQuota = cpus;
+        }
+    }
+}
+
+}
+
+ContainerLimits ContainerLimits::fromProc(const std::string& cgroup, const std::string& mountinfo,
+                                          const std::string& root, unsigned hostCpus) {
+    ContainerLimits limits;
+    limits.hostCpus = hostCpus;
+    
+    std::vector<std::string> mountLines = splitLines(mountinfo);
+    limits.container = detectContainer(cgroup, mountLines);
+    
+#ifdef _WIN32
+    (void)root;
+    return limits;
+#else
+    // /proc/self/cgroup: hierarchy-id:controllers:path, "0::path" for v2
+    std::string unifiedPath;
+    bool unified = false;
+    std::map<std::string, std::string> v1Paths;
+    for (const auto& line : splitLines(cgroup)) {
+        size_t first = line.find(':');
+        size_t second = first == std::string::npos ? first : line.find(':', first + 1);
+        if (second == std::string::npos) {
+            continue;
+        }
+        std::string controllers = line.substr(first + 1, second - first - 1);
+        std::string path = line.substr(second + 1);
+        if (line.compare(0, first, "0") == 0 && controllers.empty()) {
+            unified = true;
+            unifiedPath = path;
+            continue;
+        }
+        std::istringstream stream(controllers);
+        std::string controller;
+        while (std::getline(stream, controller, ',')) {
+            v1Paths[controller] = path;
+        }
+    }
+    
+    std::vector<CgroupMount> mounts = parseCgroupMounts(mountLines);
+    auto v1Mount = [&mounts](const std::string& controller) -> const CgroupMount* {
+        for (const auto& mount : mounts) {
+            if (mount.type == "cgroup" && hasOption(mount.options, controller)) {
+                return &mount;
+            }
+        }
+        return nullptr;
+    };
+    const CgroupMount* v2Mount = nullptr;
+    for (const auto& mount : mounts) {
+        if (mount.type == "cgroup2") {
+            v2Mount = &mount;
+        }
+    }
+    
+    // Hybrid hosts mount v2 alongside v1; the v1 controllers win when present
+    const CgroupMount* memoryMount = v1Paths.count("memory") ? v1Mount("memory") : nullptr;
+    const CgroupMount* cpuMount = v1Paths.count("cpu") ? v1Mount("cpu") : nullptr;
+    const CgroupMount* cpusetMount = v1Paths.count("cpuset") ? v1Mount("cpuset") : nullptr;
+    limits.cgroupVersion = memoryMount || cpuMount ? 1 : (unified && v2Mount ? 2 : 0);
+    if (limits.cgroupVersion == 0) {
+        return limits;
+    }
+    
+    // Every limit file of every ancestor goes into one batch
+    BatchReader reader(256);
+    std::vector<size_t> memoryFiles;
+    std::vector<std::pair<size_t, size_t>> cpuFiles;
+    size_t memoryUsedFile = 0;
+    size_t cpusetFile = 0;
+    bool haveMemoryUsed = false;
+    bool haveCpuset = false;
+    
+    if (limits.cgroupVersion == 2) {
+        std::vector<std::string> dirs = cgroupDirs(*v2Mount, unifiedPath, root);
+        for (const auto& dir : dirs) {
+            memoryFiles.push_back(reader.add(dir + "/memory.max"));
+            size_t cpuMax = reader.add(dir + "/cpu.max");
+            cpuFiles.emplace_back(cpuMax, cpuMax);
+        }
+        memoryUsedFile = reader.add(dirs.front() + "/memory.current");
+        cpusetFile = reader.add(dirs.front() + "/cpuset.cpus.effective");
+        haveMemoryUsed = haveCpuset = true;
+    } else {
+        if (memoryMount) {
+            std::vector<std::string> dirs = cgroupDirs(*memoryMount, v1Paths["memory"], root);
+            for (const auto& dir : dirs) {
+                memoryFiles.push_back(reader.add(dir + "/memory.limit_in_bytes"));
+            }
+            memoryUsedFile = reader.add(dirs.front() + "/memory.usage_in_bytes");
+            haveMemoryUsed = true;
+        }
+        if (cpuMount) {
+            for (const auto& dir : cgroupDirs(*cpuMount, v1Paths["cpu"], root)) {
+                cpuFiles.emplace_back(reader.add(dir + "/cpu.cfs_quota_us"), reader.add(dir + "/cpu.cfs_period_us"));
+            }
+        }
+        if (cpusetMount) {
+            cpusetFile = reader.add(cgroupDirs(*cpusetMount, v1Paths["cpuset"], root).front() + "/cpuset.effective_cpus");
+            haveCpuset = true;
+        }
+    }
+    reader.run();
+    
+    for (size_t file : memoryFiles) {
+        tightenMemory(limits, parseLimit(std::string(reader.firstLine(file))));
+    }
+    if (haveMemoryUsed) {
+        limits.memoryUsedBytes = parseLimit(std::string(reader.firstLine(memoryUsedFile)));
+    }
+    
+    for (const auto& files : cpuFiles) {
+        // v2 keeps "quota period" in cpu.max, v1 splits them over two files
+        std::istringstream stream(std::string(reader.firstLine(files.first)) + " " +
+                                  (files.second != files.first ? std::string(reader.firstLine(files.second)) : ""));
+        std::string quota;
+        long long period = 0;
+        if (stream >> quota >> period && quota != "max") {
+            tightenCpu(limits, std::atoll(quota.c_str()), period);
+        }
+    }
+    
+    if (haveCpuset) {
+        limits.cpuset = parseCpuList(reader.firstLine(cpusetFile));
+    }
+    return limits;
+#endif
+}
+
+#ifdef _WIN32
+
+namespace {
+
+struct JobLimits {
+    ULONGLONG memoryLimit;
+    ULONGLONG affinity;
+    DWORD cpuRate;              // 1/100 percent of all processors, 0 = no hard cap
+    DWORD containerType;        // HKLM\SYSTEM\CurrentControlSet\Control\ContainerType, 0 = none
+};
+
+bool queryJobLimits(JobLimits& limits) {
+    // A NULL job handle means the job this process belongs to, if any
+    JOBOBJECT_EXTENDED_LIMIT_INFORMATION extended;
+    if (QueryInformationJobObject(nullptr, JobObjectExtendedLimitInformation, &extended, sizeof(extended), nullptr)) {
+        DWORD flags = extended.BasicLimitInformation.LimitFlags;
+        if (flags & JOB_OBJECT_LIMIT_JOB_MEMORY) {
+            limits.memoryLimit = extended.JobMemoryLimit;
+        } else if (flags & JOB_OBJECT_LIMIT_PROCESS_MEMORY) {
+            limits.memoryLimit = extended.ProcessMemoryLimit;
+        }
+        if (flags & JOB_OBJECT_LIMIT_AFFINITY) {
+            limits.affinity = extended.BasicLimitInformation.Affinity;
+        }
+    }
+    
+    JOBOBJECT_CPU_RATE_CONTROL_INFORMATION rate;
+    if (QueryInformationJobObject(nullptr, JobObjectCpuRateControlInformation, &rate, sizeof(rate), nullptr) &&
+        (rate.ControlFlags & JOB_OBJECT_CPU_RATE_CONTROL_ENABLE) &&
+        (rate.ControlFlags & JOB_OBJECT_CPU_RATE_CONTROL_HARD_CAP)) {
+        limits.cpuRate = rate.CpuRate;
+    }
+    
+    // Set inside Windows Server and Hyper-V isolated containers
+    DWORD size = sizeof(limits.containerType);
+    RegGetValueA(HKEY_LOCAL_MACHINE, "SYSTEM\\CurrentControlSet\\Control", "ContainerType",
+        RRF_RT_REG_DWORD, nullptr, &limits.containerType, &size);
+    return true;
+}
+
+}
+
+ContainerLimits ContainerLimits::detect() {
+    ContainerLimits limits;
+    limits.hostCpus = GetActiveProcessorCount(ALL_PROCESSOR_GROUPS);
+    
+    JobLimits job = {};
+    if (!DataProvider::instance().fetchStruct<JobLimits>("container", "job", job, queryJobLimits)) {
+        return limits;
+    }
+    
+    if (job.containerType != 0) {
+        limits.container = "windows-container";
+    }
+    limits.memoryLimitBytes = job.memoryLimit;
+    if (job.cpuRate > 0) {
+        limits.cpuQuota = job.cpuRate / 10000.0 * limits.hostCpus;
+    }
+    for (unsigned cpu = 0; cpu < 64 && job.affinity; cpu++) {
+        if (job.affinity & (1ULL << cpu)) {
+            limits.cpuset.push_back(cpu);
+        }
+    }
+    return limits;
+}
+
+#else
+
+ContainerLimits ContainerLimits::detect() {
+    BatchReader reader;
+    size_t cgroup = reader.add("/proc/self/cgroup", 4096);
+    size_t mountinfo = reader.add("/proc/self/mountinfo", 256 * 1024);
+    size_t online = reader.add("/sys/devices/system/cpu/online", 256);
+    reader.run();
+    
+    return fromProc(std::string(reader.view(cgroup)), std::string(reader.view(mountinfo)), "",
+                    static_cast<unsigned>(parseCpuList(reader.firstLine(online)).size()));
+}
+
+#endif
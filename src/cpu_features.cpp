@@ -0,0 +1,253 @@
+#include "cpu_features.h"
+#include "data_provider.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#ifdef WINFETCH_HAVE_CPUID
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace {
+
+#ifdef WINFETCH_HAVE_CPUID
+
+struct Registers {
+    uint32_t eax = 0;
+    uint32_t ebx = 0;
+    uint32_t ecx = 0;
+    uint32_t edx = 0;
+};
+
+Registers cpuid(uint32_t leaf, uint32_t subleaf = 0) {
+    Registers r;
+    char key[24];
+    snprintf(key, sizeof(key), "%x:%x", leaf, subleaf);
+    DataProvider::instance().fetchStruct<Registers>("cpuid", key, r, [leaf, subleaf](Registers& out) {
+#ifdef _MSC_VER
+        int regs[4];
+        __cpuidex(regs, static_cast<int>(leaf), static_cast<int>(subleaf));
+        out.eax = static_cast<uint32_t>(regs[0]);
+        out.ebx = static_cast<uint32_t>(regs[1]);
+        out.ecx = static_cast<uint32_t>(regs[2]);
+        out.edx = static_cast<uint32_t>(regs[3]);
+#else
+        __cpuid_count(leaf, subleaf, out.eax, out.ebx, out.ecx, out.edx);
+#endif
+        return true;
+    });
+    return r;
+}
+
+// XCR0 tells which register state the OS saves on context switch
+uint64_t readXcr0() {
+    uint64_t xcr0 = 0;
+    DataProvider::instance().fetchStruct<uint64_t>("cpuid", "xgetbv:0", xcr0, [](uint64_t& out) {
+#ifdef _MSC_VER
+        out = _xgetbv(0);
+#else
+        uint32_t eax = 0;
+        uint32_t edx = 0;
+        __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        out = (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+        return true;
+    });
+    return xcr0;
+}
+
+bool bit(uint32_t value, int index) {
+    return (value >> index) & 1;
+}
+
+std::string registersToString(std::initializer_list<uint32_t> values) {
+    std::string text;
+    for (uint32_t value : values) {
+        char chunk[4];
+        std::memcpy(chunk, &value, sizeof(chunk));
+        text.append(chunk, sizeof(chunk));
+    }
+    text.erase(text.find_last_not_of(std::string(" \0", 2)) + 1);
+    text.erase(0, text.find_first_not_of(' '));
+    return text;
+}
+
+void detectWithCpuid(CpuIdentity& id) {
+    Registers leaf0 = cpuid(0);
+    uint32_t maxLeaf = leaf0.eax;
+    id.vendor = registersToString({ leaf0.ebx, leaf0.edx, leaf0.ecx });
+    
+    Registers leaf1 = cpuid(1);
+    unsigned baseFamily = (leaf1.eax >> 8) & 0xF;
+    unsigned baseModel = (leaf1.eax >> 4) & 0xF;
+    id.family = baseFamily == 0xF ? baseFamily + ((leaf1.eax >> 20) & 0xFF) : baseFamily;
+    id.model = (baseFamily == 0x6 || baseFamily == 0xF) ? baseModel + (((leaf1.eax >> 16) & 0xF) << 4) : baseModel;
+    id.stepping = leaf1.eax & 0xF;
+    id.hypervisor = bit(leaf1.ecx, 31);
+    
+    Registers leaf7;
+    if (maxLeaf >= 7) {
+        leaf7 = cpuid(7, 0);
+    }
+    
+    Registers ext1;
+    uint32_t maxExtLeaf = cpuid(0x80000000).eax;
+    if (maxExtLeaf >= 0x80000001) {
+        ext1 = cpuid(0x80000001);
+    }
+    if (maxExtLeaf >= 0x80000004) {
+        Registers b0 = cpuid(0x80000002);
+        Registers b1 = cpuid(0x80000003);
+        Registers b2 = cpuid(0x80000004);
+        id.brand = registersToString({ b0.eax, b0.ebx, b0.ecx, b0.edx,
+                                       b1.eax, b1.ebx, b1.ecx, b1.edx,
+                                       b2.eax, b2.ebx, b2.ecx, b2.edx });
+    }
+    
+    if (maxLeaf >= 0x16) {
+        Registers freq = cpuid(0x16);
+        id.baseMHz = freq.eax & 0xFFFF;
+        id.maxMHz = freq.ebx & 0xFFFF;
+    }
+    
+    if (id.hypervisor) {
+        Registers hv = cpuid(0x40000000);
+        id.hypervisorVendor = registersToString({ hv.ebx, hv.ecx, hv.edx });
+    }
+    
+    // Wide vector state is only usable if the OS saves it
+    bool osxsave = bit(leaf1.ecx, 27);
+    uint64_t xcr0 = osxsave ? readXcr0() : 0;
+    bool osAvx = (xcr0 & 0x6) == 0x6;
+    bool osAvx512 = osAvx && (xcr0 & 0xE0) == 0xE0;
+    bool osAmx = (xcr0 & 0x60000) == 0x60000;
+    
+    id.sse42 = bit(leaf1.ecx, 20);
+    id.avx = osAvx && bit(leaf1.ecx, 28);
+    id.fma = osAvx && bit(leaf1.ecx, 12);
+    id.avx2 = osAvx && bit(leaf7.ebx, 5);
+    id.avx512f = osAvx512 && bit(leaf7.ebx, 16);
+    id.avx512dq = osAvx512 && bit(leaf7.ebx, 17);
+    id.avx512cd = osAvx512 && bit(leaf7.ebx, 28);
+    id.avx512bw = osAvx512 && bit(leaf7.ebx, 30);
+    id.avx512vl = osAvx512 && bit(leaf7.ebx, 31);
+    id.amxBf16 = osAmx && bit(leaf7.edx, 22);
+    id.amxTile = osAmx && bit(leaf7.edx, 24);
+    id.amxInt8 = osAmx && bit(leaf7.edx, 25);
+    
+    // Levels as defined by the x86-64 psABI
+#if defined(_M_X64) || defined(__x86_64__)
+    id.featureLevel = 1;
+    bool v2 = bit(leaf1.ecx, 0) && bit(leaf1.ecx, 9) && bit(leaf1.ecx, 13) &&
+              bit(leaf1.ecx, 19) && id.sse42 && bit(leaf1.ecx, 23) && bit(ext1.ecx, 0);
+    bool v3 = v2 && id.avx && id.avx2 && id.fma && bit(leaf1.ecx, 29) && bit(leaf1.ecx, 22) &&
+              bit(leaf7.ebx, 3) && bit(leaf7.ebx, 8) && bit(ext1.ecx, 5);
+    bool v4 = v3 && id.avx512f && id.avx512bw && id.avx512cd && id.avx512dq && id.avx512vl;
+    if (v4) id.featureLevel = 4;
+    else if (v3) id.featureLevel = 3;
+    else if (v2) id.featureLevel = 2;
+#endif
+    
+    if (id.sse42) id.features.push_back("SSE4.2");
+    if (id.avx) id.features.push_back("AVX");
+    if (id.avx2) id.features.push_back("AVX2");
+    if (id.fma) id.features.push_back("FMA");
+    if (id.avx512f) id.features.push_back("AVX-512");
+    if (id.amxTile) id.features.push_back("AMX");
+    
+    id.fromCpuid = true;
+}
+
+#else
+
+#ifdef _WIN32
+
+void detectFromOS(CpuIdentity& id) {
+    const char* key = "HARDWARE\\DESCRIPTION\\System\\CentralProcessor\\0";
+    
+    char name[256] = {};
+    DWORD nameSize = sizeof(name);
+    if (RegGetValueA(HKEY_LOCAL_MACHINE, key, "ProcessorNameString", RRF_RT_REG_SZ, nullptr, name, &nameSize) == ERROR_SUCCESS) {
+        id.brand = name;
+    }
+    
+    char vendor[64] = {};
+    DWORD vendorSize = sizeof(vendor);
+    if (RegGetValueA(HKEY_LOCAL_MACHINE, key, "VendorIdentifier", RRF_RT_REG_SZ, nullptr, vendor, &vendorSize) == ERROR_SUCCESS) {
+        id.vendor = vendor;
+    }
+    
+    DWORD mhz = 0;
+    DWORD mhzSize = sizeof(mhz);
+    if (RegGetValueA(HKEY_LOCAL_MACHINE, key, "~MHz", RRF_RT_REG_DWORD, nullptr, &mhz, &mhzSize) == ERROR_SUCCESS) {
+        id.maxMHz = mhz;
+    }
+    
+    if (IsProcessorFeaturePresent(PF_ARM_NEON_INSTRUCTIONS_AVAILABLE)) {
+        id.features.push_back("NEON");
+    }
+}
+
+#else
+
+void detectFromOS(CpuIdentity& id) {
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    std::string implementer;
+    
+    while (std::getline(cpuinfo, line)) {
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) {
+            // Only the first processor block is needed
+            if (!id.brand.empty() && line.empty()) break;
+            continue;
+        }
+        
+        std::string key = line.substr(0, colon);
+        key.erase(key.find_last_not_of(" \t") + 1);
+        std::string value = line.substr(colon + 1);
+        value.erase(0, value.find_first_not_of(" \t"));
+        
+        if (key == "model name" || key == "Processor" || key == "Hardware" || key == "cpu") {
+            if (id.brand.empty()) id.brand = value;
+        } else if (key == "vendor_id" || key == "CPU implementer") {
+            if (id.vendor.empty()) id.vendor = value;
+        } else if (key == "Features" || key == "flags") {
+            std::string padded = " " + value + " ";
+            if (padded.find(" asimd ") != std::string::npos) id.features.push_back("NEON");
+            if (padded.find(" sve ") != std::string::npos) id.features.push_back("SVE");
+            if (padded.find(" sve2 ") != std::string::npos) id.features.push_back("SVE2");
+        }
+    }
+    
+    std::ifstream maxFreq("/sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_max_freq");
+    unsigned long kHz = 0;
+    if (maxFreq >> kHz) {
+        id.maxMHz = static_cast<unsigned>(kHz / 1000);
+    }
+}
+
+#endif
+
+#endif
+
+}
+
+CpuIdentity CpuIdentity::detect() {
+    CpuIdentity id;
+#ifdef WINFETCH_HAVE_CPUID
+    detectWithCpuid(id);
+#else
+    detectFromOS(id);
+#endif
+    return id;
+}
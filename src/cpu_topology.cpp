@@ -0,0 +1,365 @@
+#include "cpu_topology.h"
+#include "batch_reader.h"
+#include "data_provider.h"
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <cstdlib>
+#include <map>
+#include <set>
+#include <tuple>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+
+namespace {
+
+// Digits only, below 10^9; false for empty or malformed text
+bool parseNumber(std::string_view text, unsigned& value) {
+    if (text.empty() || text.size() > 9) {
+        return false;
+    }
+    value = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        value = value * 10 + static_cast<unsigned>(c - '0');
+    }
+    return true;
+}
+
+// sysfs cache sizes look like "48K" or "32768K"
+uint64_t parseCacheSize(std::string_view text) {
+    uint64_t value = 0;
+    size_t i = 0;
+    while (i < text.size() && text[i] >= '0' && text[i] <= '9') {
+        value = value * 10 + static_cast<uint64_t>(text[i] - '0');
+        i++;
+    }
+    if (i < text.size()) {
+        switch (text[i]) {
+            case 'K': value <<= 10; break;
+            case 'M': value <<= 20; break;
+            case 'G': value <<= 30; break;
+            default: break;
+        }
+    }
+    return value;
+}
+
+// Groups identical cache instances into one CpuCache entry per kind
+void addCache(std::map<std::tuple<unsigned, char, uint64_t, unsigned>, unsigned>& counts,
+              unsigned level, char type, uint64_t size, unsigned sharedBy) {
+    counts[std::make_tuple(level, type, size, sharedBy)]++;
+}
+
+std::vector<CpuCache> flattenCaches(const std::map<std::tuple<unsigned, char, uint64_t, unsigned>, unsigned>& counts) {
+    std::vector<CpuCache> caches;
+    for (const auto& entry : counts) {
+        CpuCache cache;
+        std::tie(cache.level, cache.type, cache.sizeBytes, cache.sharedBy) = entry.first;
+        cache.instances = entry.second;
+        caches.push_back(cache);
+    }
+    // L1d before L1i, then L2, L3
+    std::sort(caches.begin(), caches.end(), [](const CpuCache& a, const CpuCache& b) {
+        if (a.level != b.level) return a.level < b.level;
+        return a.type < b.type;
+    });
+    return caches;
+}
+
+}
+
+std::vector<unsigned> parseCpuList(std::string_view list) {
+    std::vector<unsigned> cpus;
+    
+    while (!list.empty()) {
+        size_t comma = list.find(',');
+        std::string_view range = list.substr(0, comma);
+        list.remove_prefix(comma == std::string_view::npos ? list.size() : comma + 1);
+        
+        // Ignore malformed ranges
+        size_t dash = range.find('-');
+        unsigned first = 0;
+        unsigned last = 0;
+        if (!parseNumber(range.substr(0, dash), first) ||
+            !parseNumber(dash == std::string_view::npos ? range : range.substr(dash + 1), last)) {
+            continue;
+        }
+        for (unsigned cpu = first; cpu <= last; cpu++) {
+            cpus.push_back(cpu);
+        }
+    }
+    
+    return cpus;
+}
+
+CpuTopology CpuTopology::fromSysfs(const std::string& root) {
+    CpuTopology topology;
+    const std::string cpuRoot = root + "/system/cpu";
+    
+    // Every sysfs attribute is planned up front and read in a few batches:
+    // the global lists, then the per-CPU files, then one batch per cache
+    // index level for the CPUs that still have one
+    BatchReader reader(256);
+    auto line = [&reader](size_t index) { return reader.firstLine(index); };
+    
+    size_t onlineFile = reader.add(cpuRoot + "/online");
+    size_t nodesFile = reader.add(root + "/system/node/online");
+    size_t pCpusFile = reader.add(root + "/cpu_core/cpus");
+    size_t eCpusFile = reader.add(root + "/cpu_atom/cpus");
+    reader.run();
+    
+    std::vector<unsigned> online = parseCpuList(line(onlineFile));
+    if (online.empty()) {
+        return topology;
+    }
+    topology.logicalProcessors = static_cast<unsigned>(online.size());
+    topology.processorGroups = 1;
+    
+    std::vector<unsigned> nodes = parseCpuList(line(nodesFile));
+    topology.numaNodes = nodes.empty() ? 1 : static_cast<unsigned>(nodes.size());
+    
+    // Intel hybrid parts expose one PMU per core type
+    std::vector<unsigned> pCpus = parseCpuList(line(pCpusFile));
+    std::vector<unsigned> eCpus = parseCpuList(line(eCpusFile));
+    
+    std::set<std::string> packages;
+    std::map<unsigned, std::string> coreOf;        // cpu -> core key
+    std::set<std::string> cores;
+    std::set<std::string> cacheInstances;
+    std::map<std::tuple<unsigned, char, uint64_t, unsigned>, unsigned> cacheCounts;
+    std::map<unsigned, unsigned> capacityOf;       // cpu -> cpu_capacity (ARM)
+    
+    const size_t FILES_PER_CPU = 4;
+    reader.clear();
+    for (unsigned cpu : online) {
+        const std::string base = cpuRoot + "/cpu" + std::to_string(cpu);
+        reader.add(base + "/topology/physical_package_id");
+        reader.add(base + "/topology/core_cpus_list");
+        reader.add(base + "/topology/thread_siblings_list");
+        reader.add(base + "/cpu_capacity");
+    }
+    reader.run();
+    
+    for (size_t i = 0; i < online.size(); i++) {
+        unsigned cpu = online[i];
+        size_t first = i * FILES_PER_CPU;
+        
+        std::string_view package = line(first);
+        packages.emplace(package);
+        
+        // core_cpus_list replaced thread_siblings_list in newer kernels
+        std::string_view siblings = line(first + 1);
+        if (siblings.empty()) {
+            siblings = line(first + 2);
+        }
+        std::string coreKey(package);
+        coreKey += ':';
+        coreKey += siblings.empty() ? std::to_string(cpu) : std::string(siblings);
+        cores.insert(coreKey);
+        coreOf[cpu] = coreKey;
+        
+        // A capacity that does not parse stays 0, as if not reported
+        std::string capacityText(line(first + 3));
+        char* end = nullptr;
+        unsigned long capacity = std::strtoul(capacityText.c_str(), &end, 10);
+        if (end == capacityText.c_str() || *end != '\0' || capacity > UINT_MAX) {
+            capacity = 0;
+        }
+        if (capacity > 0) {
+            capacityOf[cpu] = static_cast<unsigned>(capacity);
+        }
+    }
+    
+    const size_t FILES_PER_CACHE = 4;
+    std::vector<unsigned> pending = online;
+    for (int index = 0; !pending.empty(); index++) {
+        reader.clear();
+        for (unsigned cpu : pending) {
+            const std::string cacheBase = cpuRoot + "/cpu" + std::to_string(cpu) + "/cache/index" + std::to_string(index);
+            reader.add(cacheBase + "/level");
+            reader.add(cacheBase + "/shared_cpu_list");
+            reader.add(cacheBase + "/type");
+            reader.add(cacheBase + "/size");
+        }
+        reader.run();
+        
+        std::vector<unsigned> more;
+        for (size_t i = 0; i < pending.size(); i++) {
+            size_t first = i * FILES_PER_CACHE;
+            std::string_view level = line(first);
+            if (level.empty()) {
+                continue;
+            }
+            more.push_back(pending[i]);
+            
+            unsigned levelNumber = 0;
+            if (!parseNumber(level, levelNumber)) {
+                continue;
+            }
+            
+            std::string_view shared = line(first + 1);
+            std::string_view type = line(first + 2);
+            // Each instance is seen once per CPU sharing it; count it once
+            std::string instance(level);
+            instance.append(type).append(":").append(shared);
+            if (!cacheInstances.insert(std::move(instance)).second) {
+                continue;
+            }
+            
+            char typeCode = type == "Data" ? 'D' : type == "Instruction" ? 'I' : 'U';
+            addCache(cacheCounts, levelNumber, typeCode,
+                     parseCacheSize(line(first + 3)),
+                     static_cast<unsigned>(parseCpuList(shared).size()));
+        }
+        pending.swap(more);
+    }
+    
+    topology.packages = static_cast<unsigned>(packages.size());
+    topology.physicalCores = static_cast<unsigned>(cores.size());
+    topology.caches = flattenCaches(cacheCounts);
+    
+    // ARM big.LITTLE reports a relative capacity per CPU instead
+    if (pCpus.empty() && eCpus.empty() && !capacityOf.empty()) {
+        unsigned maxCapacity = 0;
+        for (const auto& entry : capacityOf) {
+            maxCapacity = std::max(maxCapacity, entry.second);
+        }
+        for (const auto& entry : capacityOf) {
+            (entry.second == maxCapacity ? pCpus : eCpus).push_back(entry.first);
+        }
+    }
+    
+    if (!pCpus.empty() && !eCpus.empty()) {
+        std::set<std::string> pCores;
+        std::set<std::string> eCores;
+        for (unsigned cpu : pCpus) {
+            if (coreOf.count(cpu)) pCores.insert(coreOf[cpu]);
+        }
+        for (unsigned cpu : eCpus) {
+            if (coreOf.count(cpu)) eCores.insert(coreOf[cpu]);
+        }
+        topology.performanceCores = static_cast<unsigned>(pCores.size());
+        topology.efficiencyCores = static_cast<unsigned>(eCores.size());
+    }
+    
+    return topology;
+}
+
+#ifdef _WIN32
+
+CpuTopology CpuTopology::detect() {
+    CpuTopology topology;
+    
+    std::string raw = DataProvider::instance().fetch("cpu", "GetLogicalProcessorInformationEx", []() {
+        DWORD length = 0;
+        GetLogicalProcessorInformationEx(RelationAll, nullptr, &length);
+        if (GetLastError() != ERROR_INSUFFICIENT_BUFFER || length == 0) {
+            return std::string();
+        }
+        
+        std::string records(length, '\0');
+        auto* first = reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(&records[0]);
+        if (!GetLogicalProcessorInformationEx(RelationAll, first, &length)) {
+            return std::string();
+        }
+        records.resize(length);
+        return records;
+    });
+    if (raw.empty()) {
+        return topology;
+    }
+    
+    // Zero padding keeps the fixed fields of a short last record inside
+    // the buffer
+    std::vector<uint8_t> buffer(raw.size() + sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX), 0);
+    std::copy(raw.begin(), raw.end(), buffer.begin());
+    DWORD length = static_cast<DWORD>(raw.size());
+    
+    std::vector<BYTE> efficiencyClasses;
+    std::map<std::tuple<unsigned, char, uint64_t, unsigned>, unsigned> cacheCounts;
+    
+    // Records are variable-sized; each one carries its own Size. A replayed
+    // capture may be truncated or corrupt, so a record that is smaller than
+    // its header or runs past the buffer ends the walk.
+    const DWORD HEADER_SIZE = offsetof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX, Processor);
+    const DWORD MASKS_OFFSET = offsetof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX, Processor.GroupMask);
+    for (DWORD offset = 0; length - offset >= HEADER_SIZE; ) {
+        auto* info = reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data() + offset);
+        if (info->Size < HEADER_SIZE || info->Size > length - offset) {
+            break;
+        }
+        
+        switch (info->Relationship) {
+            case RelationProcessorCore: {
+                topology.physicalCores++;
+                // A core never spans groups, but count every mask anyway;
+                // only masks that fit inside the record are read
+                DWORD fittingMasks = info->Size > MASKS_OFFSET ? static_cast<DWORD>((info->Size - MASKS_OFFSET) / sizeof(GROUP_AFFINITY)) : 0;
+                WORD groups = static_cast<WORD>(std::min<DWORD>(info->Processor.GroupCount, fittingMasks));
+                for (WORD g = 0; g < groups; g++) {
+                    topology.logicalProcessors += popcount64(static_cast<uint64_t>(info->Processor.GroupMask[g].Mask));
+                }
+                efficiencyClasses.push_back(info->Processor.EfficiencyClass);
+                break;
+            }
+            case RelationProcessorPackage:
+                topology.packages++;
+                break;
+            case RelationNumaNode:
+                topology.numaNodes++;
+                break;
+            case RelationGroup:
+                topology.processorGroups = info->Group.ActiveGroupCount;
+                break;
+            case RelationCache: {
+                const CACHE_RELATIONSHIP& cache = info->Cache;
+                char type = cache.Type == CacheData ? 'D' : cache.Type == CacheInstruction ? 'I' : 'U';
+                if (cache.Type == CacheTrace) {
+                    break;
+                }
+                addCache(cacheCounts, cache.Level, type, cache.CacheSize,
+                         popcount64(static_cast<uint64_t>(cache.GroupMask.Mask)));
+                break;
+            }
+            default:
+                break;
+        }
+        
+        offset += info->Size;
+    }
+    
+    topology.caches = flattenCaches(cacheCounts);
+    
+    // Hybrid parts report a higher efficiency class for performance cores
+    if (!efficiencyClasses.empty()) {
+        auto range = std::minmax_element(efficiencyClasses.begin(), efficiencyClasses.end());
+        if (*range.first != *range.second) {
+            BYTE performanceClass = *range.second;
+            for (BYTE efficiencyClass : efficiencyClasses) {
+                if (efficiencyClass == performanceClass) {
+                    topology.performanceCores++;
+                } else {
+                    topology.efficiencyCores++;
+                }
+            }
+        }
+    }
+    
+    return topology;
+}
+
+#else
+
+CpuTopology CpuTopology::detect() {
+    return fromSysfs("/sys/devices");
+}
+
+#endif
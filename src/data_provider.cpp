@@ -0,0 +1,157 @@
+#include "data_provider.h"
+#include <sstream>
+#include <thread>
+
+namespace {
+
+const char* const CAPTURE_HEADER = "# winfetch provider capture v1";
+
+std::string makeKey(const std::string& kind, const std::string& key) {
+    return kind + '\x1f' + key;
+}
+
+}
+
+DataProvider& DataProvider::instance() {
+    static DataProvider provider;
+    return provider;
+}
+
+bool DataProvider::startRecording(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    capture.open(path, std::ios::binary | std::ios::trunc);
+    if (!capture.is_open()) {
+        return false;
+    }
+    capture << CAPTURE_HEADER << "\n";
+    mode = Mode::Record;
+    return true;
+}
+
+bool DataProvider::startReplay(const std::string& path, bool withLatency) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    
+    // One answer per line: kind <TAB> latency in us <TAB> key <TAB> value
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        
+        size_t t1 = line.find('\t');
+        size_t t2 = t1 == std::string::npos ? t1 : line.find('\t', t1 + 1);
+        size_t t3 = t2 == std::string::npos ? t2 : line.find('\t', t2 + 1);
+        if (t3 == std::string::npos) {
+            continue;
+        }
+        
+        Answer answer;
+        try {
+            answer.latencyUs = std::stoll(line.substr(t1 + 1, t2 - t1 - 1));
+        } catch (const std::exception&) {
+            continue;
+        }
+        answer.value = unescape(line.substr(t3 + 1));
+        
+        std::string kind = line.substr(0, t1);
+        std::string key = unescape(line.substr(t2 + 1, t3 - t2 - 1));
+        replayData[makeKey(kind, key)].answers.push_back(answer);
+    }
+    
+    mode = Mode::Replay;
+    replayLatency = withLatency;
+    return true;
+}
+
+std::string DataProvider::fetch(const std::string& kind, const std::string& key,
+                                const std::function<std::string()>& live) {
+    if (mode == Mode::Live) {
+        return live();
+    }
+    
+    if (mode == Mode::Replay) {
+        Answer answer;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = replayData.find(makeKey(kind, key));
+            if (it == replayData.end() || it->second.answers.empty()) {
+                missCount++;
+                return std::string();
+            }
+            
+            // Repeated queries (watch mode) walk through the recorded
+            // answers in order and then keep returning the last one
+            Recorded& recorded = it->second;
+            answer = recorded.answers[recorded.next];
+            if (recorded.next + 1 < recorded.answers.size()) {
+                recorded.next++;
+            }
+        }
+        
+        if (replayLatency && answer.latencyUs > 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(answer.latencyUs));
+        }
+        return answer.value;
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    std::string value = live();
+    long long latency = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    capture << kind << "\t" << latency << "\t" << escape(key) << "\t" << escape(value) << "\n";
+    capture.flush();
+    return value;
+}
+
+std::string DataProvider::escape(const std::string& text) {
+    static const char HEX[] = "0123456789abcdef";
+    std::string escaped;
+    escaped.reserve(text.size());
+    
+    for (char c : text) {
+        unsigned char byte = static_cast<unsigned char>(c);
+        if (c == '\\') {
+            escaped += "\\\\";
+        } else if (byte < 0x20 || byte >= 0x7F) {
+            // Keeps binary answers (firmware tables, structs) on one line
+            escaped += "\\x";
+            escaped += HEX[byte >> 4];
+            escaped += HEX[byte & 0xF];
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+std::string DataProvider::unescape(const std::string& text) {
+    auto hexValue = [](char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return 0;
+    };
+    
+    std::string value;
+    value.reserve(text.size());
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] == '\\' && i + 1 < text.size()) {
+            if (text[i + 1] == 'x' && i + 3 < text.size()) {
+                value += static_cast<char>((hexValue(text[i + 2]) << 4) | hexValue(text[i + 3]));
+                i += 3;
+                continue;
+            }
+            value += text[i + 1];
+            i++;
+            continue;
+        }
+        value += text[i];
+    }
+    return value;
+}
@@ -1,115 +1,187 @@
 #include "display.h"
+#include "module_registry.h"
 #include <iostream>
 #include <iomanip>
 #include <sstream>
 
+#ifndef _WIN32
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+// Console colors are only touched by the <true> instantiations
+template <>
+void Display::setColor<false>(int) {
+}
+
+template <>
+void Display::resetColor<false>() {
+}
+
+#ifdef _WIN32
+template <>
+void Display::setColor<true>(int color) {
+    WORD winColor = WIN_COLOR_WHITE;
+    
+    switch (color) {
+        case COLOR_BLACK: winColor = WIN_COLOR_BLACK; break;
+        case COLOR_RED: winColor = WIN_COLOR_RED; break;
+        case COLOR_GREEN: winColor = WIN_COLOR_GREEN; break;
+        case COLOR_YELLOW: winColor = WIN_COLOR_YELLOW; break;
+        case COLOR_BLUE: winColor = WIN_COLOR_BLUE; break;
+        case COLOR_MAGENTA: winColor = WIN_COLOR_MAGENTA; break;
+        case COLOR_CYAN: winColor = WIN_COLOR_CYAN; break;
+        case COLOR_WHITE: winColor = WIN_COLOR_WHITE; break;
+        case COLOR_BRIGHT_WHITE: winColor = WIN_COLOR_BRIGHT_WHITE; break;
+        default: winColor = WIN_COLOR_WHITE; break;
+    }
+    
+    SetConsoleTextAttribute(hConsole, winColor);
+}
+
+template <>
+void Display::resetColor<true>() {
+    SetConsoleTextAttribute(hConsole, WIN_COLOR_WHITE);
+}
+#else
+// Other terminals take the configured ANSI codes as they are
+template <>
+void Display::setColor<true>(int color) {
+    std::cout << "\033[" << color << "m";
+}
+
+template <>
+void Display::resetColor<true>() {
+    std::cout << "\033[0m";
+}
+#endif
+
 Display::Display(const Config& config) : config(config), asciiArt(config) {
+    palette.logo = config.getLogoColor();
+    palette.label = config.getLabelColor();
+    palette.section = config.getSectionColor();
+    palette.title = config.getTitleColor();
+    palette.separator = config.getSeparatorColor();
+    useColors = config.getUseColors();
+#ifdef _WIN32
     hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
+#endif
 }
 
 Display::~Display() {
-    resetColor();
+    if (useColors) {
+        resetColor<true>();
+    }
 }
 
 void Display::showSystemInfo(const SystemInfo& sysInfo) {
+    if (useColors) {
+        render<true>(sysInfo);
+    } else {
+        render<false>(sysInfo);
+    }
+}
+
+void Display::printLogo() {
+    useColors ? printLogo<true>() : printLogo<false>();
+}
+
+void Display::printSeparator() {
+    useColors ? printSeparator<true>() : printSeparator<false>();
+}
+
+void Display::printTitle() {
+    useColors ? printTitle<true>() : printTitle<false>();
+}
+
+template <bool Colors>
+void Display::render(const SystemInfo& sysInfo) {
     // Clear screen if configured
     if (config.getClearScreen()) {
+#ifdef _WIN32
         system("cls");
+#else
+        std::cout << "\033[H\033[2J";
+#endif
     }
     
     // Print title
     if (config.getShowTitle()) {
-        printTitle();
+        printTitle<Colors>();
         std::cout << std::endl;
     }
     
     // Print logo
     if (config.getShowLogo()) {
-        printLogo();
+        printLogo<Colors>();
     }
     
     // Print system information
-    printSystemInfo(sysInfo);
-    printHardwareInfo(sysInfo);
-    printStorageInfo(sysInfo);
-    printDesktopInfo(sysInfo);
+    printSystemInfo<Colors>(sysInfo);
+    printHardwareInfo<Colors>(sysInfo);
+    printStorageInfo<Colors>(sysInfo);
+    printDesktopInfo<Colors>(sysInfo);
+    printWindowsInfo<Colors>(sysInfo);
+    printCustomInfo<Colors>(sysInfo);
     
     // Print separator at the end
-    printSeparator();
+    printSeparator<Colors>();
 }
 
+template <bool Colors>
 void Display::printLogo() {
     std::vector<std::string> logo = asciiArt.getLogo();
     
     for (const auto& line : logo) {
-        setColor(config.getLogoColor());
+        setColor<Colors>(palette.logo);
         std::cout << line << std::endl;
-        resetColor();
+        resetColor<Colors>();
     }
     std::cout << std::endl;
 }
 
+template <bool Colors>
 void Display::printInfoLine(const std::string& label, const std::string& value, int color) {
-    setColor(config.getLabelColor());
+    setColor<Colors>(palette.label);
     std::cout << label << ": ";
-    resetColor();
+    resetColor<Colors>();
     
-    setColor(color);
+    setColor<Colors>(color);
     std::cout << value << std::endl;
-    resetColor();
+    resetColor<Colors>();
 }
 
+template <bool Colors>
+void Display::printSection(const char* title) {
+    setColor<Colors>(palette.section);
+    std::cout << title << std::endl;
+    resetColor<Colors>();
+}
+
+template <bool Colors>
 void Display::printSeparator() {
-    setColor(config.getSeparatorColor());
+    setColor<Colors>(palette.separator);
     std::cout << std::string(50, '-') << std::endl;
-    resetColor();
+    resetColor<Colors>();
 }
 
+template <bool Colors>
 void Display::printTitle() {
-    setColor(config.getTitleColor());
+    setColor<Colors>(palette.title);
     printCentered("Winfetch - Windows System Information");
-    resetColor();
-}
-
-void Display::setColor(int color) {
-    if (!config.getUseColors()) {
-        return;
-    }
-    
-    CONSOLE_SCREEN_BUFFER_INFO csbi;
-    GetConsoleScreenBufferInfo(hConsole, &csbi);
-    
-    WORD winColor = WIN_COLOR_WHITE;
-    
-    switch (color) {
-        case COLOR_BLACK: winColor = WIN_COLOR_BLACK; break;
-        case COLOR_RED: winColor = WIN_COLOR_RED; break;
-        case COLOR_GREEN: winColor = WIN_COLOR_GREEN; break;
-        case COLOR_YELLOW: winColor = WIN_COLOR_YELLOW; break;
-        case COLOR_BLUE: winColor = WIN_COLOR_BLUE; break;
-        case COLOR_MAGENTA: winColor = WIN_COLOR_MAGENTA; break;
-        case COLOR_CYAN: winColor = WIN_COLOR_CYAN; break;
-        case COLOR_WHITE: winColor = WIN_COLOR_WHITE; break;
-        case COLOR_BRIGHT_WHITE: winColor = WIN_COLOR_BRIGHT_WHITE; break;
-        default: winColor = WIN_COLOR_WHITE; break;
-    }
-    
-    SetConsoleTextAttribute(hConsole, winColor);
-}
-
-void Display::resetColor() {
-    if (!config.getUseColors()) {
-        return;
-    }
-    
-    SetConsoleTextAttribute(hConsole, WIN_COLOR_WHITE);
+    resetColor<Colors>();
 }
 
 void Display::printCentered(const std::string& text) {
+#ifdef _WIN32
     CONSOLE_SCREEN_BUFFER_INFO csbi;
     GetConsoleScreenBufferInfo(hConsole, &csbi);
     
     int width = csbi.srWindow.Right - csbi.srWindow.Left + 1;
+#else
+    struct winsize size;
+    int width = ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 ? size.ws_col : 80;
+#endif
     int textWidth = static_cast<int>(text.length());
     int padding = (width - textWidth) / 2;
     
@@ -143,81 +215,183 @@ std::string Display::formatInfoLine(const std::string& label, const std::string&
     return label + ": " + value;
 }
 
+// Lines of modules left out of the build are discarded at compile time,
+// together with their labels
+template <bool Colors>
 void Display::printSystemInfo(const SystemInfo& sysInfo) {
-    setColor(config.getSectionColor());
-    std::cout << "System Information:" << std::endl;
-    resetColor();
-    
-    printInfoLine("OS", sysInfo.windowsEdition + " " + sysInfo.architecture, COLOR_CYAN);
-    printInfoLine("Version", sysInfo.osVersion + " Build " + sysInfo.osBuild, COLOR_WHITE);
-    printInfoLine("Uptime", sysInfo.uptime, COLOR_GREEN);
-    printInfoLine("Language", sysInfo.language, COLOR_YELLOW);
-    printInfoLine("Timezone", sysInfo.timezone, COLOR_YELLOW);
-    
-    std::cout << std::endl;
+    if constexpr (moduleEnabled(COLLECT_OS) || moduleEnabled(COLLECT_UPTIME) || moduleEnabled(COLLECT_PACKAGES)) {
+        printSection<Colors>("System Information:");
+        
+        if constexpr (moduleEnabled(COLLECT_OS)) {
+            printInfoLine<Colors>("OS", sysInfo.windowsEdition + " " + sysInfo.architecture, COLOR_CYAN);
+            printInfoLine<Colors>("Version", sysInfo.osVersion + " Build " + sysInfo.osBuild, COLOR_WHITE);
+        }
+        if constexpr (moduleEnabled(COLLECT_UPTIME)) {
+            printInfoLine<Colors>("Uptime", sysInfo.uptime, COLOR_GREEN);
+        }
+        if constexpr (moduleEnabled(COLLECT_PACKAGES)) {
+            if (!sysInfo.packages.empty()) {
+                printInfoLine<Colors>("Packages", sysInfo.packages, COLOR_WHITE);
+            }
+        }
+        if constexpr (moduleEnabled(COLLECT_UPTIME)) {
+            printInfoLine<Colors>("Language", sysInfo.language, COLOR_YELLOW);
+            printInfoLine<Colors>("Timezone", sysInfo.timezone, COLOR_YELLOW);
+        }
+        
+        std::cout << std::endl;
+    }
 }
 
+template <bool Colors>
 void Display::printHardwareInfo(const SystemInfo& sysInfo) {
-    setColor(config.getSectionColor());
-    std::cout << "Hardware Information:" << std::endl;
-    resetColor();
-    
-    printInfoLine("CPU", sysInfo.cpuName, COLOR_CYAN);
-    printInfoLine("Cores", sysInfo.cpuCores + " cores, " + sysInfo.cpuThreads + " threads", COLOR_WHITE);
-    if (!sysInfo.cpuFrequency.empty()) {
-        printInfoLine("Frequency", sysInfo.cpuFrequency, COLOR_WHITE);
-    }
-    printInfoLine("Memory", sysInfo.totalMemory + " (" + sysInfo.memoryUsage + " used)", COLOR_GREEN);
-    if (!sysInfo.gpuDriver.empty() && sysInfo.gpuDriver != "Unknown") {
-        printInfoLine("GPU", sysInfo.gpuName + " (Display Driver: " + sysInfo.gpuDriver + ")", COLOR_MAGENTA);
-    } else {
-        printInfoLine("GPU", sysInfo.gpuName, COLOR_MAGENTA);
+    if constexpr (moduleEnabled(COLLECT_CPU) || moduleEnabled(COLLECT_MEMORY) ||
+                  moduleEnabled(COLLECT_FIRMWARE) || moduleEnabled(COLLECT_GPU)) {
+        printSection<Colors>("Hardware Information:");
+        
+        if constexpr (moduleEnabled(COLLECT_CPU)) {
+            printInfoLine<Colors>("CPU", sysInfo.cpuName, COLOR_CYAN);
+            std::string cpuLimit = sysInfo.cpuLimit.empty() ? "" : " [limit " + sysInfo.cpuLimit + "]";
+            if (!sysInfo.cpuCoreTypes.empty()) {
+                printInfoLine<Colors>("Cores", sysInfo.cpuCores + " cores (" + sysInfo.cpuCoreTypes + "), " + sysInfo.cpuThreads + " threads" + cpuLimit, COLOR_WHITE);
+            } else {
+                printInfoLine<Colors>("Cores", sysInfo.cpuCores + " cores, " + sysInfo.cpuThreads + " threads" + cpuLimit, COLOR_WHITE);
+            }
+            if (!sysInfo.cpuTopology.empty()) {
+                printInfoLine<Colors>("Topology", sysInfo.cpuTopology, COLOR_WHITE);
+            }
+            if (!sysInfo.cpuCache.empty()) {
+                printInfoLine<Colors>("Cache", sysInfo.cpuCache, COLOR_WHITE);
+            }
+            if (!sysInfo.cpuFeatures.empty()) {
+                printInfoLine<Colors>("Features", sysInfo.cpuFeatures, COLOR_WHITE);
+            }
+            if (!sysInfo.cpuHypervisor.empty()) {
+                printInfoLine<Colors>("Hypervisor", sysInfo.cpuHypervisor, COLOR_WHITE);
+            }
+            if (!sysInfo.container.empty()) {
+                printInfoLine<Colors>("Container", sysInfo.container, COLOR_WHITE);
+            }
+            if (!sysInfo.cpuFrequency.empty()) {
+                printInfoLine<Colors>("Frequency", sysInfo.cpuFrequency, COLOR_WHITE);
+            }
+        }
+        if constexpr (moduleEnabled(COLLECT_MEMORY)) {
+            if (!sysInfo.memoryLimit.empty()) {
+                printInfoLine<Colors>("Memory", sysInfo.totalMemory + " (" + sysInfo.memoryUsage + " used) [limit " + sysInfo.memoryLimit + "]", COLOR_GREEN);
+            } else {
+                printInfoLine<Colors>("Memory", sysInfo.totalMemory + " (" + sysInfo.memoryUsage + " used)", COLOR_GREEN);
+            }
+            if (!sysInfo.memoryCommit.empty()) {
+                printInfoLine<Colors>("Commit", sysInfo.memoryCommit, COLOR_WHITE);
+            }
+            if (!sysInfo.memorySwap.empty()) {
+                printInfoLine<Colors>("Page File", sysInfo.memorySwap, COLOR_WHITE);
+            }
+            if (!sysInfo.memoryCache.empty()) {
+                printInfoLine<Colors>("File Cache", sysInfo.memoryCache, COLOR_WHITE);
+            }
+            if (!sysInfo.memoryHugePages.empty()) {
+                printInfoLine<Colors>("Huge Pages", sysInfo.memoryHugePages, COLOR_WHITE);
+            }
+            if (!sysInfo.memoryPressure.empty()) {
+                printInfoLine<Colors>("Pressure", sysInfo.memoryPressure, COLOR_YELLOW);
+            }
+        }
+        if constexpr (moduleEnabled(COLLECT_FIRMWARE)) {
+            for (const auto& module : sysInfo.memoryModules) {
+                printInfoLine<Colors>("RAM", module, COLOR_GREEN);
+            }
+        }
+        if constexpr (moduleEnabled(COLLECT_GPU)) {
+            if (!sysInfo.gpuDriver.empty() && sysInfo.gpuDriver != "Unknown") {
+                printInfoLine<Colors>("GPU", sysInfo.gpuName + " (Display Driver: " + sysInfo.gpuDriver + ")", COLOR_MAGENTA);
+            } else {
+                printInfoLine<Colors>("GPU", sysInfo.gpuName, COLOR_MAGENTA);
+            }
+        }
+        if constexpr (moduleEnabled(COLLECT_FIRMWARE)) {
+            if (!sysInfo.boardName.empty()) {
+                printInfoLine<Colors>("Board", sysInfo.boardName, COLOR_WHITE);
+            }
+            if (!sysInfo.biosVersion.empty()) {
+                printInfoLine<Colors>("BIOS", sysInfo.biosVersion, COLOR_WHITE);
+            }
+            if (!sysInfo.chassisType.empty() && sysInfo.chassisType != "Unknown") {
+                printInfoLine<Colors>("Chassis", sysInfo.chassisType, COLOR_WHITE);
+            }
+        }
+        
+        std::cout << std::endl;
     }
-    
-    std::cout << std::endl;
 }
 
+template <bool Colors>
 void Display::printStorageInfo(const SystemInfo& sysInfo) {
-    if (sysInfo.drives.empty()) {
-        return;
-    }
-    
-    setColor(config.getSectionColor());
-    std::cout << "Storage Information:" << std::endl;
-    resetColor();
-    
-    for (size_t i = 0; i < sysInfo.drives.size(); i++) {
-        std::string driveInfo = sysInfo.drives[i] + " " + sysInfo.driveSizes[i] + " (" + sysInfo.driveFree[i] + " free)";
-        printInfoLine("Drive", driveInfo, COLOR_BLUE);
+    if constexpr (moduleEnabled(COLLECT_STORAGE)) {
+        if (sysInfo.drives.empty()) {
+            return;
+        }
+        
+        printSection<Colors>("Storage Information:");
+        
+        for (size_t i = 0; i < sysInfo.drives.size(); i++) {
+            std::string driveInfo = sysInfo.drives[i] + " " + sysInfo.driveSizes[i] + " (" + sysInfo.driveFree[i] + " free)";
+            printInfoLine<Colors>("Drive", driveInfo, COLOR_BLUE);
+        }
+        
+        std::cout << std::endl;
     }
-    
-    std::cout << std::endl;
 }
 
+template <bool Colors>
 void Display::printDesktopInfo(const SystemInfo& sysInfo) {
-    setColor(config.getSectionColor());
-    std::cout << "Desktop Information:" << std::endl;
-    resetColor();
-    
-    printInfoLine("Username", sysInfo.username, COLOR_WHITE);
-    printInfoLine("PC Name", sysInfo.domain, COLOR_YELLOW);
-    
-    std::cout << std::endl;
+    if constexpr (moduleEnabled(COLLECT_NETWORK)) {
+        printSection<Colors>("Desktop Information:");
+        
+        printInfoLine<Colors>("Username", sysInfo.username, COLOR_WHITE);
+        printInfoLine<Colors>("PC Name", sysInfo.domain, COLOR_YELLOW);
+        
+        std::cout << std::endl;
+    }
 }
 
+template <bool Colors>
 void Display::printWindowsInfo(const SystemInfo& sysInfo) {
-    setColor(config.getSectionColor());
-    std::cout << "Windows Information:" << std::endl;
-    resetColor();
-    
-    if (!sysInfo.windowsActivation.empty() && sysInfo.windowsActivation != "Unknown") {
-        printInfoLine("Activation", sysInfo.windowsActivation, COLOR_GREEN);
+    if constexpr (moduleEnabled(COLLECT_WINDOWS)) {
+        auto known = [](const std::string& value) { return !value.empty() && value != "Unknown"; };
+        if (!known(sysInfo.windowsActivation) && !known(sysInfo.windowsDefender) && !known(sysInfo.windowsUpdate)) {
+            return;
+        }
+        
+        printSection<Colors>("Windows Information:");
+        
+        if (known(sysInfo.windowsActivation)) {
+            bool activated = sysInfo.windowsActivation == "Activated";
+            printInfoLine<Colors>("Activation", sysInfo.windowsActivation, activated ? COLOR_GREEN : COLOR_RED);
+        }
+        if (known(sysInfo.windowsDefender)) {
+            bool protectedState = sysInfo.windowsDefender.compare(0, 9, "Protected") == 0;
+            printInfoLine<Colors>("Defender", sysInfo.windowsDefender, protectedState ? COLOR_GREEN : COLOR_RED);
+        }
+        if (known(sysInfo.windowsUpdate)) {
+            printInfoLine<Colors>("Updates", sysInfo.windowsUpdate, COLOR_YELLOW);
+        }
+        
+        std::cout << std::endl;
     }
-    if (!sysInfo.windowsDefender.empty() && sysInfo.windowsDefender != "Unknown") {
-        printInfoLine("Defender", sysInfo.windowsDefender, COLOR_RED);
+}
+
+template <bool Colors>
+void Display::printCustomInfo(const SystemInfo& sysInfo) {
+    if (sysInfo.customModules.empty()) {
+        return;
     }
-    if (!sysInfo.windowsUpdate.empty() && sysInfo.windowsUpdate != "Unknown") {
-        printInfoLine("Updates", sysInfo.windowsUpdate, COLOR_YELLOW);
+    
+    printSection<Colors>("Custom Information:");
+    
+    for (const auto& module : sysInfo.customModules) {
+        printInfoLine<Colors>(module.label, module.value, module.timedOut ? COLOR_RED : COLOR_CYAN);
     }
     
     std::cout << std::endl;
@@ -0,0 +1,776 @@
+#include "fleet_archive.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+namespace {
+
+// On-disk layout, all offsets from the start of the file:
+//   ArchiveHeader
+//   ArchiveColumnEntry[columns]
+//   column names
+//   per column, 8-byte aligned: rows * width bytes of values, then for
+//   string columns uint64 offsets[dictionarySize + 1] and the string bytes
+const char ARCHIVE_MAGIC[8] = {'W', 'F', 'A', 'R', 'C', 'H', '0', '1'};
+
+struct ArchiveHeader {
+    char magic[8];
+    uint64_t rows;
+    uint64_t columns;
+    uint64_t reserved;
+};
+
+struct ArchiveColumnEntry {
+    uint64_t nameOffset;
+    uint64_t nameLength;
+    uint64_t dataOffset;
+    uint64_t dictionaryOffset;
+    uint64_t dictionarySize;
+    uint32_t numeric;
+    uint32_t width;
+};
+
+// Scans are not worth a thread for fewer rows than this
+const uint64_t ROWS_PER_WORKER = 16384;
+
+uint64_t allOnes(unsigned width) {
+    return width >= 8 ? ~0ULL : (1ULL << (width * 8)) - 1;
+}
+
+uint64_t readPacked(const unsigned char* p, unsigned width) {
+    switch (width) {
+        case 1: return *p;
+        case 2: { uint16_t v; std::memcpy(&v, p, 2); return v; }
+        case 4: { uint32_t v; std::memcpy(&v, p, 4); return v; }
+        default: { uint64_t v; std::memcpy(&v, p, 8); return v; }
+    }
+}
+
+void writePacked(std::vector<char>& out, uint64_t value, unsigned width) {
+    char bytes[8];
+    std::memcpy(bytes, &value, 8);
+    out.insert(out.end(), bytes, bytes + width);
+}
+
+template <typename T>
+void append(std::vector<char>& out, const T& value) {
+    const char* bytes = reinterpret_cast<const char*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+void align8(std::vector<char>& out) {
+    out.resize((out.size() + 7) & ~static_cast<size_t>(7));
+}
+
+// Lossless as a number: digits only, no leading zero, below 2^64 - 1
+bool parseUnsigned(const std::string& text, uint64_t& value) {
+    if (text.empty() || text.size() > 19 || (text.size() > 1 && text[0] == '0')) {
+        return false;
+    }
+    value = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        value = value * 10 + static_cast<uint64_t>(c - '0');
+    }
+    return true;
+}
+
+void appendUtf8(std::string& out, unsigned codePoint) {
+    if (codePoint < 0x80) {
+        out += static_cast<char>(codePoint);
+    } else if (codePoint < 0x800) {
+        out += static_cast<char>(0xC0 | (codePoint >> 6));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else if (codePoint < 0x10000) {
+        out += static_cast<char>(0xE0 | (codePoint >> 12));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (codePoint >> 18));
+        out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+}
+
+// Minimal reader for the flat objects --json prints: string keys, string
+// or literal values
+class JsonCursor {
+public:
+    explicit JsonCursor(std::string_view text) : text(text) {}
+    
+    bool atEnd() { skipSpace(); return pos >= text.size(); }
+    bool consume(char c) {
+        skipSpace();
+        if (pos < text.size() && text[pos] == c) {
+            pos++;
+            return true;
+        }
+        return false;
+    }
+    
+    // Moves to the next '{' after a parse error
+    void recover() {
+        size_t next = text.find('{', pos + 1);
+        pos = next == std::string_view::npos ? text.size() : next;
+    }
+    
+    bool readString(std::string& out) {
+        out.clear();
+        if (!consume('"')) {
+            return false;
+        }
+        while (pos < text.size()) {
+            char c = text[pos++];
+            if (c == '"') {
+                return true;
+            }
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos >= text.size()) {
+                return false;
+            }
+            char escape = text[pos++];
+            switch (escape) {
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'u': {
+                    unsigned codePoint = 0;
+                    if (!hex4(pos, codePoint)) {
+                        return false;
+                    }
+                    pos += 4;
+                    
+                    // Characters outside the BMP arrive as a \uD8xx\uDCxx
+                    // surrogate pair; an unpaired half becomes U+FFFD
+                    unsigned low = 0;
+                    if (codePoint >= 0xD800 && codePoint < 0xDC00) {
+                        if (text.substr(pos, 2) == "\\u" && hex4(pos + 2, low) && low >= 0xDC00 && low < 0xE000) {
+                            codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                            pos += 6;
+                        } else {
+                            codePoint = 0xFFFD;
+                        }
+                    } else if (codePoint >= 0xDC00 && codePoint < 0xE000) {
+                        codePoint = 0xFFFD;
+                    }
+                    appendUtf8(out, codePoint);
+                    break;
+                }
+                default: out += escape; break;
+            }
+        }
+        return false;
+    }
+    
+    // Strings, or numbers and literals kept as written
+    bool readValue(std::string& out) {
+        skipSpace();
+        if (pos < text.size() && text[pos] == '"') {
+            return readString(out);
+        }
+        size_t start = pos;
+        while (pos < text.size() && text[pos] != ',' && text[pos] != '}' && !isSpace(text[pos])) {
+            pos++;
+        }
+        out.assign(text.substr(start, pos - start));
+        return !out.empty() && out.find_first_of("{[\"") == std::string::npos;
+    }
+
+private:
+    static bool isSpace(char c) { return c == ' ' || c == '\n' || c == '\r' || c == '\t'; }
+    void skipSpace() {
+        while (pos < text.size() && isSpace(text[pos])) {
+            pos++;
+        }
+    }
+    
+    // The four hex digits of a \u escape, starting at offset at
+    bool hex4(size_t at, unsigned& value) const {
+        if (at + 4 > text.size()) {
+            return false;
+        }
+        value = 0;
+        for (size_t i = at; i < at + 4; i++) {
+            char c = text[i];
+            if (c >= '0' && c <= '9') {
+                value = value * 16 + static_cast<unsigned>(c - '0');
+            } else if (c >= 'a' && c <= 'f') {
+                value = value * 16 + static_cast<unsigned>(c - 'a' + 10);
+            } else if (c >= 'A' && c <= 'F') {
+                value = value * 16 + static_cast<unsigned>(c - 'A' + 10);
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    std::string_view text;
+    size_t pos = 0;
+};
+
+// Splits [0, rows) into one contiguous range per worker and runs them
+// in parallel; work(worker, begin, end)
+template <typename Work>
+unsigned parallelRows(uint64_t rows, Work work) {
+    unsigned workers = std::max(1u, std::thread::hardware_concurrency());
+    workers = static_cast<unsigned>(std::max<uint64_t>(1, std::min<uint64_t>(workers, rows / ROWS_PER_WORKER)));
+    
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < workers; i++) {
+        threads.emplace_back(work, i, rows * i / workers, rows * (i + 1) / workers);
+    }
+    work(0u, 0ULL, rows / workers);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return workers;
+}
+
+// Accepts 12, 1.5, 10% and binary units such as 8G or 512MB
+bool parseNumber(const std::string& text, double& number) {
+    char* end = nullptr;
+    number = std::strtod(text.c_str(), &end);
+    if (end == text.c_str()) {
+        return false;
+    }
+    std::string suffix(end);
+    if (suffix == "%") {
+        number /= 100;
+        return true;
+    }
+    const char* units = "KMGT";
+    if (!suffix.empty() && std::strchr(units, suffix[0]) && (suffix.size() == 1 || suffix.substr(1) == "B")) {
+        number *= std::pow(1024.0, static_cast<double>(std::strchr(units, suffix[0]) - units + 1));
+        return true;
+    }
+    return suffix.empty();
+}
+
+std::string trim(const std::string& text) {
+    size_t first = text.find_first_not_of(" \t");
+    size_t last = text.find_last_not_of(" \t");
+    return first == std::string::npos ? "" : text.substr(first, last - first + 1);
+}
+
+}
+
+void ArchiveWriter::add(const Snapshot& snapshot) {
+    rowCount++;
+    for (auto& column : columns) {
+        column.codes.resize(rowCount, 0);
+    }
+    
+    for (const auto& entry : snapshot) {
+        auto found = columnIndex.find(entry.first);
+        if (found == columnIndex.end()) {
+            // Rows before the first snapshot with this key stay missing
+            found = columnIndex.emplace(entry.first, columns.size()).first;
+            columns.emplace_back();
+            columns.back().name = entry.first;
+            columns.back().codes.resize(rowCount, 0);
+        }
+        
+        Column& column = columns[found->second];
+        auto interned = column.lookup.find(entry.second);
+        uint32_t code;
+        if (interned != column.lookup.end()) {
+            code = interned->second;
+        } else {
+            column.strings.push_back(entry.second);
+            code = static_cast<uint32_t>(column.strings.size());
+            column.lookup.emplace(column.strings.back(), code);
+        }
+        column.codes[rowCount - 1] = code;
+    }
+}
+
+bool ArchiveWriter::write(const std::string& path) const {
+    std::vector<char> out;
+    ArchiveHeader header = {};
+    std::memcpy(header.magic, ARCHIVE_MAGIC, sizeof(header.magic));
+    header.rows = rowCount;
+    header.columns = columns.size();
+    append(out, header);
+    
+    size_t directory = out.size();
+    out.resize(out.size() + columns.size() * sizeof(ArchiveColumnEntry));
+    
+    std::vector<ArchiveColumnEntry> entries(columns.size());
+    for (size_t i = 0; i < columns.size(); i++) {
+        entries[i].nameOffset = out.size();
+        entries[i].nameLength = columns[i].name.size();
+        out.insert(out.end(), columns[i].name.begin(), columns[i].name.end());
+    }
+    
+    for (size_t i = 0; i < columns.size(); i++) {
+        const Column& column = columns[i];
+        ArchiveColumnEntry& entry = entries[i];
+        
+        // Numeric when every distinct value is; the dictionary then maps
+        // codes straight to numbers
+        std::vector<uint64_t> numbers(column.strings.size() + 1, 0);
+        bool numeric = !column.strings.empty();
+        uint64_t largest = 0;
+        for (size_t code = 1; numeric && code <= column.strings.size(); code++) {
+            numeric = parseUnsigned(column.strings[code - 1], numbers[code]);
+            largest = std::max(largest, numbers[code]);
+        }
+        
+        // Numbers keep all ones free as the missing marker
+        unsigned width = 1;
+        uint64_t needed = numeric ? largest + 1 : column.strings.size();
+        while (width < 8 && needed > allOnes(width)) {
+            width *= 2;
+        }
+        entry.numeric = numeric ? 1 : 0;
+        entry.width = width;
+        
+        align8(out);
+        entry.dataOffset = out.size();
+        out.reserve(out.size() + column.codes.size() * width);
+        for (uint32_t code : column.codes) {
+            uint64_t value = numeric ? (code ? numbers[code] : allOnes(width)) : code;
+            writePacked(out, value, width);
+        }
+        
+        if (!numeric) {
+            align8(out);
+            entry.dictionaryOffset = out.size();
+            entry.dictionarySize = column.strings.size();
+            uint64_t offset = 0;
+            append(out, offset);
+            for (const auto& text : column.strings) {
+                offset += text.size();
+                append(out, offset);
+            }
+            for (const auto& text : column.strings) {
+                out.insert(out.end(), text.begin(), text.end());
+            }
+        }
+    }
+    
+    std::memcpy(out.data() + directory, entries.data(), entries.size() * sizeof(ArchiveColumnEntry));
+    
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(out.data(), static_cast<std::streamsize>(out.size()));
+    return file.good();
+}
+
+size_t ArchiveWriter::parseSnapshots(std::string_view text, std::vector<Snapshot>& snapshots) {
+    JsonCursor cursor(text);
+    size_t parsed = 0;
+    std::string key;
+    std::string value;
+    
+    while (!cursor.atEnd()) {
+        if (!cursor.consume('{')) {
+            cursor.recover();
+            continue;
+        }
+        
+        Snapshot snapshot;
+        bool ok = true;
+        if (!cursor.consume('}')) {
+            do {
+                ok = cursor.readString(key) && cursor.consume(':') && cursor.readValue(value);
+                if (ok) {
+                    snapshot.emplace_back(key, value);
+                }
+            } while (ok && cursor.consume(','));
+            ok = ok && cursor.consume('}');
+        }
+        
+        if (!ok) {
+            cursor.recover();
+            continue;
+        }
+        snapshots.push_back(std::move(snapshot));
+        parsed++;
+    }
+    return parsed;
+}
+
+FleetArchive::FleetArchive(const std::string& path) : file(path) {
+    if (!file.valid() || file.size() < sizeof(ArchiveHeader)) {
+        return;
+    }
+    
+    const unsigned char* base = reinterpret_cast<const unsigned char*>(file.data());
+    uint64_t size = file.size();
+    ArchiveHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, ARCHIVE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.columns > (size - sizeof(header)) / sizeof(ArchiveColumnEntry)) {
+        return;
+    }
+    rowCount = header.rows;
+    
+    // Every section is checked against the file size, so a truncated
+    // archive is rejected instead of read past its end
+    auto fits = [size](uint64_t offset, uint64_t length) {
+        return offset <= size && length <= size - offset;
+    };
+    for (uint64_t i = 0; i < header.columns; i++) {
+        ArchiveColumnEntry entry;
+        std::memcpy(&entry, base + sizeof(header) + i * sizeof(entry), sizeof(entry));
+        if (!fits(entry.nameOffset, entry.nameLength) || (entry.width != 1 && entry.width != 2 && entry.width != 4 && entry.width != 8) ||
+            rowCount > size / entry.width || !fits(entry.dataOffset, rowCount * entry.width)) {
+            return;
+        }
+        
+        Column column;
+        column.name = std::string_view(file.data() + entry.nameOffset, entry.nameLength);
+        column.numeric = entry.numeric != 0;
+        column.width = entry.width;
+        column.data = base + entry.dataOffset;
+        if (!column.numeric) {
+            if (entry.dictionarySize >= size / 8 || !fits(entry.dictionaryOffset, (entry.dictionarySize + 1) * 8)) {
+                return;
+            }
+            column.dictionarySize = entry.dictionarySize;
+            column.offsets = base + entry.dictionaryOffset;
+            column.strings = file.data() + entry.dictionaryOffset + (entry.dictionarySize + 1) * 8;
+            if (!fits(entry.dictionaryOffset + (entry.dictionarySize + 1) * 8, readPacked(column.offsets + entry.dictionarySize * 8, 8))) {
+                return;
+            }
+            
+            // With the offsets in order, every entry lies inside the
+            // string bytes checked above
+            for (uint64_t code = 0; code < entry.dictionarySize; code++) {
+                if (readPacked(column.offsets + code * 8, 8) > readPacked(column.offsets + (code + 1) * 8, 8)) {
+                    return;
+                }
+            }
+        }
+        columnList.push_back(column);
+    }
+    isValid = true;
+}
+
+const FleetArchive::Column* FleetArchive::column(std::string_view name) const {
+    for (const auto& column : columnList) {
+        if (column.name == name) {
+            return &column;
+        }
+    }
+    return nullptr;
+}
+
+uint64_t FleetArchive::value(const Column& column, uint64_t row) {
+    return readPacked(column.data + row * column.width, column.width);
+}
+
+bool FleetArchive::isMissing(const Column& column, uint64_t value) {
+    return column.numeric ? value == allOnes(column.width) : value == 0;
+}
+
+std::string_view FleetArchive::string(const Column& column, uint64_t code) const {
+    if (column.numeric || code == 0 || code > column.dictionarySize) {
+        return std::string_view();
+    }
+    uint64_t begin = readPacked(column.offsets + (code - 1) * 8, 8);
+    uint64_t end = readPacked(column.offsets + code * 8, 8);
+    return std::string_view(column.strings + begin, end - begin);
+}
+
+std::string FleetArchive::text(const Column& column, uint64_t row) const {
+    uint64_t stored = value(column, row);
+    if (isMissing(column, stored)) {
+        return "";
+    }
+    return column.numeric ? std::to_string(stored) : std::string(string(column, stored));
+}
+
+ArchiveQuery::ArchiveQuery(const FleetArchive& archive) : archive(archive) {
+}
+
+bool ArchiveQuery::where(const std::string& expression, std::string& error) {
+    // Earliest operator wins; two-character ones before their prefixes
+    const char* ops[] = {"!=", "<=", ">=", "=", "<", ">", "~"};
+    const Op opCodes[] = {NOT_EQUAL, LESS_EQUAL, GREATER_EQUAL, EQUAL, LESS, GREATER, CONTAINS};
+    size_t at = std::string::npos;
+    size_t opLength = 0;
+    Filter filter;
+    for (size_t i = 0; i < sizeof(ops) / sizeof(ops[0]); i++) {
+        size_t found = expression.find(ops[i]);
+        if (found != std::string::npos && (found < at || (found == at && std::strlen(ops[i]) > opLength))) {
+            at = found;
+            opLength = std::strlen(ops[i]);
+            filter.op = opCodes[i];
+        }
+    }
+    if (at == std::string::npos) {
+        error = "no operator in filter '" + expression + "'";
+        return false;
+    }
+    
+    std::string lhs = trim(expression.substr(0, at));
+    std::string rhs = trim(expression.substr(at + opLength));
+    if (rhs.size() >= 2 && rhs.front() == '"' && rhs.back() == '"') {
+        rhs = rhs.substr(1, rhs.size() - 2);
+    }
+    
+    std::string divisorName;
+    size_t slash = lhs.find('/');
+    if (slash != std::string::npos) {
+        divisorName = trim(lhs.substr(slash + 1));
+        lhs = trim(lhs.substr(0, slash));
+    }
+    
+    filter.column = archive.column(lhs);
+    if (!filter.column) {
+        error = "no column '" + lhs + "'";
+        return false;
+    }
+    if (!divisorName.empty()) {
+        filter.divisor = archive.column(divisorName);
+        if (!filter.divisor) {
+            error = "no column '" + divisorName + "'";
+            return false;
+        }
+        if (!filter.column->numeric || !filter.divisor->numeric) {
+            error = "ratios need numeric columns";
+            return false;
+        }
+    }
+    
+    if (filter.column->numeric) {
+        if (filter.op == CONTAINS || !parseNumber(rhs, filter.number)) {
+            error = "column '" + lhs + "' is numeric; compare it with a number";
+            return false;
+        }
+    } else {
+        // Decided once per distinct string instead of once per row
+        const FleetArchive::Column& column = *filter.column;
+        filter.pass.assign(column.dictionarySize + 1, 0);
+        for (uint64_t code = 1; code <= column.dictionarySize; code++) {
+            std::string_view value = archive.string(column, code);
+            int order = value.compare(rhs);
+            bool pass = false;
+            switch (filter.op) {
+                case EQUAL: pass = order == 0; break;
+                case NOT_EQUAL: pass = order != 0; break;
+                case LESS: pass = order < 0; break;
+                case LESS_EQUAL: pass = order <= 0; break;
+                case GREATER: pass = order > 0; break;
+                case GREATER_EQUAL: pass = order >= 0; break;
+                case CONTAINS: pass = value.find(rhs) != std::string_view::npos; break;
+            }
+            filter.pass[code] = pass ? 1 : 0;
+        }
+    }
+    
+    filters.push_back(std::move(filter));
+    return true;
+}
+
+bool ArchiveQuery::matches(uint64_t row) const {
+    for (const auto& filter : filters) {
+        uint64_t stored = FleetArchive::value(*filter.column, row);
+        if (!filter.column->numeric) {
+            if (stored >= filter.pass.size() || !filter.pass[stored]) {
+                return false;
+            }
+            continue;
+        }
+        if (FleetArchive::isMissing(*filter.column, stored)) {
+            return false;
+        }
+        
+        double value = static_cast<double>(stored);
+        if (filter.divisor) {
+            uint64_t divisor = FleetArchive::value(*filter.divisor, row);
+            if (FleetArchive::isMissing(*filter.divisor, divisor) || divisor == 0) {
+                return false;
+            }
+            value /= static_cast<double>(divisor);
+        }
+        
+        bool pass = false;
+        switch (filter.op) {
+            case EQUAL: pass = value == filter.number; break;
+            case NOT_EQUAL: pass = value != filter.number; break;
+            case LESS: pass = value < filter.number; break;
+            case LESS_EQUAL: pass = value <= filter.number; break;
+            case GREATER: pass = value > filter.number; break;
+            case GREATER_EQUAL: pass = value >= filter.number; break;
+            case CONTAINS: break;
+        }
+        if (!pass) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint64_t ArchiveQuery::count() const {
+    std::vector<uint64_t> counts(std::max(1u, std::thread::hardware_concurrency()), 0);
+    unsigned workers = parallelRows(archive.rows(), [this, &counts](unsigned worker, uint64_t begin, uint64_t end) {
+        uint64_t matched = 0;
+        for (uint64_t row = begin; row < end; row++) {
+            matched += matches(row) ? 1 : 0;
+        }
+        counts[worker] = matched;
+    });
+    
+    uint64_t total = 0;
+    for (unsigned i = 0; i < workers; i++) {
+        total += counts[i];
+    }
+    return total;
+}
+
+std::vector<std::pair<std::string, uint64_t>> ArchiveQuery::countBy(const std::string& name, std::string& error) const {
+    std::vector<std::pair<std::string, uint64_t>> result;
+    const FleetArchive::Column* column = archive.column(name);
+    if (!column) {
+        error = "no column '" + name + "'";
+        return result;
+    }
+    
+    // String columns count straight into a slot per dictionary code;
+    // numeric ones need a map per worker
+    unsigned slots = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::vector<uint64_t>> codeCounts(slots);
+    std::vector<std::unordered_map<uint64_t, uint64_t>> numberCounts(slots);
+    unsigned workers = parallelRows(archive.rows(), [&](unsigned worker, uint64_t begin, uint64_t end) {
+        if (!column->numeric) {
+            codeCounts[worker].assign(column->dictionarySize + 1, 0);
+        }
+        for (uint64_t row = begin; row < end; row++) {
+            if (!matches(row)) {
+                continue;
+            }
+            uint64_t stored = FleetArchive::value(*column, row);
+            if (column->numeric) {
+                numberCounts[worker][stored]++;
+            } else if (stored <= column->dictionarySize) {
+                codeCounts[worker][stored]++;
+            }
+        }
+    });
+    
+    if (column->numeric) {
+        std::unordered_map<uint64_t, uint64_t> merged;
+        for (unsigned i = 0; i < workers; i++) {
+            for (const auto& entry : numberCounts[i]) {
+                merged[entry.first] += entry.second;
+            }
+        }
+        for (const auto& entry : merged) {
+            bool missing = FleetArchive::isMissing(*column, entry.first);
+            result.emplace_back(missing ? "(missing)" : std::to_string(entry.first), entry.second);
+        }
+    } else {
+        for (uint64_t code = 0; code <= column->dictionarySize; code++) {
+            uint64_t total = 0;
+            for (unsigned i = 0; i < workers; i++) {
+                total += codeCounts[i][code];
+            }
+            if (total > 0) {
+                result.emplace_back(code == 0 ? "(missing)" : std::string(archive.string(*column, code)), total);
+            }
+        }
+    }
+    
+    std::sort(result.begin(), result.end(), [](const std::pair<std::string, uint64_t>& a, const std::pair<std::string, uint64_t>& b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    });
+    return result;
+}
+
+std::vector<ArchiveQuery::Bucket> ArchiveQuery::histogram(const std::string& name, unsigned buckets, std::string& error) const {
+    std::vector<Bucket> result;
+    const FleetArchive::Column* column = archive.column(name);
+    if (!column) {
+        error = "no column '" + name + "'";
+        return result;
+    }
+    if (!column->numeric) {
+        error = "column '" + name + "' holds text; use --count-by";
+        return result;
+    }
+    buckets = std::max(1u, buckets);
+    
+    // First pass for the range, second to fill the buckets
+    unsigned slots = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::pair<uint64_t, uint64_t>> ranges(slots, std::make_pair(~0ULL, 0ULL));
+    unsigned workers = parallelRows(archive.rows(), [&](unsigned worker, uint64_t begin, uint64_t end) {
+        for (uint64_t row = begin; row < end; row++) {
+            uint64_t stored = FleetArchive::value(*column, row);
+            if (!FleetArchive::isMissing(*column, stored) && matches(row)) {
+                ranges[worker].first = std::min(ranges[worker].first, stored);
+                ranges[worker].second = std::max(ranges[worker].second, stored);
+            }
+        }
+    });
+    
+    uint64_t low = ~0ULL;
+    uint64_t high = 0;
+    for (unsigned i = 0; i < workers; i++) {
+        low = std::min(low, ranges[i].first);
+        high = std::max(high, ranges[i].second);
+    }
+    if (low > high) {
+        return result;
+    }
+    
+    double width = static_cast<double>(high - low + 1) / buckets;
+    std::vector<std::vector<uint64_t>> counts(slots);
+    parallelRows(archive.rows(), [&](unsigned worker, uint64_t begin, uint64_t end) {
+        counts[worker].assign(buckets, 0);
+        for (uint64_t row = begin; row < end; row++) {
+            uint64_t stored = FleetArchive::value(*column, row);
+            if (!FleetArchive::isMissing(*column, stored) && matches(row)) {
+                size_t bucket = static_cast<size_t>(static_cast<double>(stored - low) / width);
+                counts[worker][std::min<size_t>(bucket, buckets - 1)]++;
+            }
+        }
+    });
+    
+    for (unsigned b = 0; b < buckets; b++) {
+        Bucket bucket = { low + width * b, low + width * (b + 1), 0 };
+        for (unsigned i = 0; i < workers; i++) {
+            bucket.count += counts[i][b];
+        }
+        result.push_back(bucket);
+    }
+    return result;
+}
+
+std::vector<std::string> ArchiveQuery::list(const std::string& name, std::string& error) const {
+    std::vector<std::string> result;
+    const FleetArchive::Column* column = archive.column(name);
+    if (!column) {
+        error = "no column '" + name + "'";
+        return result;
+    }
+    
+    std::vector<std::vector<uint64_t>> rows(std::max(1u, std::thread::hardware_concurrency()));
+    unsigned workers = parallelRows(archive.rows(), [this, &rows](unsigned worker, uint64_t begin, uint64_t end) {
+        for (uint64_t row = begin; row < end; row++) {
+            if (matches(row)) {
+                rows[worker].push_back(row);
+            }
+        }
+    });
+    
+    for (unsigned i = 0; i < workers; i++) {
+        for (uint64_t row : rows[i]) {
+            result.push_back(archive.text(*column, row));
+        }
+    }
+    return result;
+}
@@ -1,15 +1,26 @@
+#include <cstdio>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <vector>
-#include <windows.h>
 #include "system_info.h"
 #include "display.h"
 #include "config.h"
 #include "ascii_art.h"
+#include "plugin_modules.h"
+#include "change_monitor.h"
+#include "data_provider.h"
+#include "archive_cli.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
 
 void printUsage() {
     std::cout << "Winfetch - Windows System Information Tool\n";
-    std::cout << "Usage: winfetch [options]\n\n";
+    std::cout << "Usage: winfetch [options]\n";
+    std::cout << "       winfetch archive <output> <snapshot file or directory>...\n";
+    std::cout << "       winfetch query <archive> [--where <filter>]... [action]\n\n";
     std::cout << "Options:\n";
     std::cout << "  -h, --help     Show this help message\n";
     std::cout << "  -c, --config   Specify config file path\n";
@@ -17,6 +28,11 @@ void printUsage() {
     std::cout << "  --no-logo      Hide ASCII logo\n";
     std::cout << "  --no-colors    Disable colored output\n";
     std::cout << "  --no-title     Hide window title\n";
+    std::cout << "  --watch        Keep running and redraw when the system changes\n";
+    std::cout << "  --json         Print the collected information as JSON\n";
+    std::cout << "  --record-provider <file>  Save every raw system query and its latency\n";
+    std::cout << "  --replay-provider <file>  Answer system queries from a recorded file\n";
+    std::cout << "  --replay-latency          With --replay-provider, wait as long as the recorded queries took\n";
 }
 
 void printVersion() {
@@ -24,12 +40,83 @@ void printVersion() {
     std::cout << "A Windows system information tool inspired by fastfetch\n";
 }
 
+std::string jsonEscape(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        switch (c) {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\r': escaped += "\\r"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buffer[8];
+                    snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                    escaped += buffer;
+                } else {
+                    escaped += c;
+                }
+                break;
+        }
+    }
+    return escaped;
+}
+
+void printJson(const SystemInfo& sysInfo) {
+    std::cout << "{";
+    bool first = true;
+    for (const auto& entry : sysInfo.toKeyValues(COLLECT_ALL)) {
+        std::cout << (first ? "\n" : ",\n") << "  \"" << jsonEscape(entry.first) << "\": \"" << jsonEscape(entry.second) << "\"";
+        first = false;
+    }
+    std::cout << "\n}" << std::endl;
+}
+
+// Only pause when winfetch owns its console window (started from Explorer),
+// never when run from a shell, a script or another program
+bool ownsConsole() {
+#ifdef _WIN32
+    // Redirected input or output means a script or pipe is attached
+    if (GetFileType(GetStdHandle(STD_INPUT_HANDLE)) != FILE_TYPE_CHAR ||
+        GetFileType(GetStdHandle(STD_OUTPUT_HANDLE)) != FILE_TYPE_CHAR) {
+        return false;
+    }
+    
+    DWORD processes[2];
+    return GetConsoleProcessList(processes, 2) == 1;
+#else
+    return false;
+#endif
+}
+
+void pauseIfOwnConsole() {
+    if (ownsConsole()) {
+        std::cout << "Press Enter to exit...";
+        std::cin.get();
+    }
+}
+
 int main(int argc, char* argv[]) {
+    // Fleet archive subcommands work on collected --json snapshots, not
+    // on this machine
+    if (argc > 1 && std::string(argv[1]) == "archive") {
+        return runArchiveCommand(argc - 2, argv + 2);
+    }
+    if (argc > 1 && std::string(argv[1]) == "query") {
+        return runQueryCommand(argc - 2, argv + 2);
+    }
+    
     // Parse command line arguments
     bool showLogo = true;
     bool useColors = true;
     bool showTitle = true;
+    bool watch = false;
+    bool json = false;
     std::string configPath = "";
+    std::string recordPath;
+    std::string replayPath;
+    bool replayLatency = false;
     
     for (int i = 1; i < argc; i++) {
         std::string arg = argv[i];
@@ -51,6 +138,23 @@ int main(int argc, char* argv[]) {
         else if (arg == "--no-title") {
             showTitle = false;
         }
+        else if (arg == "--watch") {
+            watch = true;
+        }
+        else if (arg == "--json") {
+            json = true;
+        }
+        else if (arg == "--record-provider" || arg == "--replay-provider") {
+            if (i + 1 < argc) {
+                (arg == "--record-provider" ? recordPath : replayPath) = argv[++i];
+            } else {
+                std::cerr << "Error: " << arg << " requires a file path\n";
+                return 1;
+            }
+        }
+        else if (arg == "--replay-latency") {
+            replayLatency = true;
+        }
         else if (arg == "-c" || arg == "--config") {
             if (i + 1 < argc) {
                 configPath = argv[++i];
@@ -66,6 +170,21 @@ int main(int argc, char* argv[]) {
         }
     }
     
+    if (!recordPath.empty() && !replayPath.empty()) {
+        std::cerr << "Error: --record-provider and --replay-provider cannot be combined\n";
+        return 1;
+    }
+    
+    DataProvider& provider = DataProvider::instance();
+    if (!recordPath.empty() && !provider.startRecording(recordPath)) {
+        std::cerr << "Error: cannot write " << recordPath << "\n";
+        return 1;
+    }
+    if (!replayPath.empty() && !provider.startReplay(replayPath, replayLatency)) {
+        std::cerr << "Error: cannot read " << replayPath << "\n";
+        return 1;
+    }
+    
     try {
         // Initialize configuration
         Config config;
@@ -77,24 +196,62 @@ int main(int argc, char* argv[]) {
         if (!useColors) config.setUseColors(false);
         if (!showLogo) config.setShowLogo(false);
         if (!showTitle) config.setShowTitle(false);
+        if (watch) config.setClearScreen(true);
         
-        // Initialize display system
-        Display display(config);
+        // Start custom modules so they run alongside the built-in collectors
+        PluginRunner plugins(config);
+        plugins.start();
         
         // Gather system information
         SystemInfo sysInfo;
+        sysInfo.customModules = plugins.collect();
+        
+        if (provider.misses() > 0) {
+            std::cerr << "Warning: " << provider.misses() << " queries were not in the replay file\n";
+        }
+        
+        if (json) {
+            printJson(sysInfo);
+            return 0;
+        }
+        
+        // Initialize display system
+        Display display(config);
         
         // Display the information
         display.showSystemInfo(sysInfo);
         
+        if (watch) {
+            // Sleep until the OS reports a change; only the affected
+            // collectors run again. Uptime and memory usage drift on their
+            // own, so they are refreshed on a slow tick.
+            ChangeMonitor monitor;
+            const auto tick = std::chrono::seconds(60);
+            
+            while (true) {
+                unsigned changed = monitor.waitForChanges(tick);
+                
+                // As at startup, custom modules run alongside the refresh
+                std::unique_ptr<PluginRunner> tickPlugins;
+                if (changed == 0) {
+                    changed = COLLECT_UPTIME | COLLECT_MEMORY;
+                    tickPlugins.reset(new PluginRunner(config));
+                    tickPlugins->start();
+                }
+                sysInfo.refresh(changed);
+                if (tickPlugins) {
+                    sysInfo.customModules = tickPlugins->collect();
+                }
+                display.showSystemInfo(sysInfo);
+            }
+        }
+        
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
-        std::cout << "Press Enter to exit...";
-        std::cin.get();
+        pauseIfOwnConsole();
         return 1;
     }
     
-    std::cout << "Press Enter to exit...";
-    std::cin.get();
+    pauseIfOwnConsole();
     return 0;
 }
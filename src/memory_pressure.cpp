@@ -0,0 +1,213 @@
+#include "memory_pressure.h"
+#include "data_provider.h"
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <winternl.h>
+#else
+#include "batch_reader.h"
+#endif
+
+namespace {
+
+std::string_view nextLine(std::string_view& text) {
+    size_t end = text.find('\n');
+    std::string_view line = text.substr(0, end);
+    text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+    return line;
+}
+
+// "Key:   1234 kB" -> bytes; page counts carry no unit
+unsigned long long meminfoValue(std::string_view rest) {
+    std::string value(rest);
+    char* end = nullptr;
+    unsigned long long number = std::strtoull(value.c_str(), &end, 10);
+    while (*end == ' ') {
+        end++;
+    }
+    return end[0] == 'k' && end[1] == 'B' ? number * 1024 : number;
+}
+
+// "some avg10=0.12 avg60=0.30 avg300=0.25 total=123456"
+void parsePressureLine(std::string_view line, double (&averages)[3]) {
+    const char* keys[] = {"avg10=", "avg60=", "avg300="};
+    for (int i = 0; i < 3; i++) {
+        size_t at = line.find(keys[i]);
+        if (at != std::string_view::npos) {
+            averages[i] = std::strtod(std::string(line.substr(at + std::strlen(keys[i]))).c_str(), nullptr);
+        }
+    }
+}
+
+}
+
+MemoryPressure MemoryPressure::fromProc(std::string_view meminfo, std::string_view pressure) {
+    MemoryPressure result;
+    unsigned long long swapFree = 0;
+    unsigned long long writeback = 0;
+    
+    while (!meminfo.empty()) {
+        std::string_view line = nextLine(meminfo);
+        size_t colon = line.find(':');
+        if (colon == std::string_view::npos) {
+            continue;
+        }
+        
+        std::string_view key = line.substr(0, colon);
+        std::string_view rest = line.substr(colon + 1);
+        if (key == "MemTotal") result.totalBytes = meminfoValue(rest);
+        else if (key == "MemAvailable") result.availableBytes = meminfoValue(rest);
+        else if (key == "Committed_AS") result.commitBytes = meminfoValue(rest);
+        else if (key == "CommitLimit") result.commitLimitBytes = meminfoValue(rest);
+        else if (key == "SwapTotal") result.swapTotalBytes = meminfoValue(rest);
+        else if (key == "SwapFree") swapFree = meminfoValue(rest);
+        else if (key == "Cached") result.cachedBytes = meminfoValue(rest);
+        else if (key == "Dirty") result.dirtyBytes = meminfoValue(rest);
+        else if (key == "Writeback") writeback = meminfoValue(rest);
+        else if (key == "Hugepagesize") result.hugePageBytes = meminfoValue(rest);
+        else if (key == "HugePages_Total") result.hugePagesTotal = meminfoValue(rest);
+        else if (key == "HugePages_Free") result.hugePagesFree = meminfoValue(rest);
+        else if (key == "AnonHugePages") result.transparentHugeBytes = meminfoValue(rest);
+    }
+    
+    result.swapUsedBytes = result.swapTotalBytes > swapFree ? result.swapTotalBytes - swapFree : 0;
+    // Pages being written count as dirty until the write completes
+    result.dirtyBytes += writeback;
+    
+    while (!pressure.empty()) {
+        std::string_view line = nextLine(pressure);
+        if (line.compare(0, 5, "some ") == 0) {
+            parsePressureLine(line, result.someAvg);
+            result.hasPressure = true;
+        } else if (line.compare(0, 5, "full ") == 0) {
+            parsePressureLine(line, result.fullAvg);
+        }
+    }
+    return result;
+}
+
+#ifdef _WIN32
+
+namespace {
+
+// NtQuerySystemInformation classes and layouts, as used by Task Manager
+// and RAMMap; neither is in the SDK headers
+const int SYSTEM_PAGE_FILE_INFORMATION = 18;
+const int SYSTEM_MEMORY_LIST_INFORMATION = 80;
+
+struct PageFileEntry {
+    ULONG nextEntryOffset;
+    ULONG totalSize;            // Pages
+    ULONG totalInUse;
+    ULONG peakUsage;
+    UNICODE_STRING name;
+};
+
+struct MemoryListInformation {
+    ULONG_PTR zeroPageCount;
+    ULONG_PTR freePageCount;
+    ULONG_PTR modifiedPageCount;
+    ULONG_PTR modifiedNoWritePageCount;
+    ULONG_PTR badPageCount;
+    ULONG_PTR pageCountByPriority[8];       // Standby list, per priority
+    ULONG_PTR repurposedPagesByPriority[8];
+    ULONG_PTR modifiedPageCountPageFile;
+};
+
+struct MemoryCounters {
+    ULONGLONG commitLimit;
+    ULONGLONG commitAvailable;
+    ULONGLONG pageSize;
+    ULONGLONG largePageSize;
+    ULONGLONG pageFileTotal;    // Pages
+    ULONGLONG pageFileUsed;
+    ULONGLONG standbyPages;
+    ULONGLONG modifiedPages;
+};
+
+typedef NTSTATUS (NTAPI *NtQuerySystemInformationFn)(ULONG, PVOID, ULONG, PULONG);
+
+bool queryMemoryCounters(MemoryCounters& counters) {
+    MEMORYSTATUSEX status;
+    status.dwLength = sizeof(status);
+    if (!GlobalMemoryStatusEx(&status)) {
+        return false;
+    }
+    // The "page file" totals here are the system commit limit and what is
+    // left of it
+    counters.commitLimit = status.ullTotalPageFile;
+    counters.commitAvailable = status.ullAvailPageFile;
+    
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    counters.pageSize = info.dwPageSize;
+    counters.largePageSize = GetLargePageMinimum();
+    
+    static NtQuerySystemInformationFn query = reinterpret_cast<NtQuerySystemInformationFn>(
+        GetProcAddress(GetModuleHandleA("ntdll.dll"), "NtQuerySystemInformation"));
+    if (!query) {
+        return true;
+    }
+    
+    // One entry per page file, chained by offset
+    alignas(8) unsigned char buffer[4096];
+    if (NT_SUCCESS(query(SYSTEM_PAGE_FILE_INFORMATION, buffer, sizeof(buffer), nullptr))) {
+        for (size_t offset = 0; offset + sizeof(PageFileEntry) <= sizeof(buffer);) {
+            const PageFileEntry* entry = reinterpret_cast<const PageFileEntry*>(buffer + offset);
+            counters.pageFileTotal += entry->totalSize;
+            counters.pageFileUsed += entry->totalInUse;
+            if (entry->nextEntryOffset == 0) {
+                break;
+            }
+            offset += entry->nextEntryOffset;
+        }
+    }
+    
+    MemoryListInformation lists = {};
+    if (NT_SUCCESS(query(SYSTEM_MEMORY_LIST_INFORMATION, &lists, sizeof(lists), nullptr))) {
+        for (ULONG_PTR pages : lists.pageCountByPriority) {
+            counters.standbyPages += pages;
+        }
+        counters.modifiedPages = lists.modifiedPageCount;
+    }
+    return true;
+}
+
+}
+
+MemoryPressure MemoryPressure::sample() {
+    MemoryPressure result;
+    MemoryCounters counters = {};
+    if (!DataProvider::instance().fetchStruct<MemoryCounters>("memory", "counters", counters, queryMemoryCounters)) {
+        return result;
+    }
+    
+    result.commitLimitBytes = counters.commitLimit;
+    result.commitBytes = counters.commitLimit - counters.commitAvailable;
+    result.swapTotalBytes = counters.pageFileTotal * counters.pageSize;
+    result.swapUsedBytes = counters.pageFileUsed * counters.pageSize;
+    result.cachedBytes = counters.standbyPages * counters.pageSize;
+    result.dirtyBytes = counters.modifiedPages * counters.pageSize;
+    // Large pages have no system-wide pool to report, only their size
+    result.hugePageBytes = counters.largePageSize;
+    return result;
+}
+
+#else
+
+MemoryPressure MemoryPressure::sample() {
+    // Kept per thread so the io_uring ring and buffers are set up once,
+    // not on every tick
+    static thread_local BatchReader reader;
+    reader.clear();
+    size_t meminfo = reader.add("/proc/meminfo", 8192);
+    size_t pressure = reader.add("/proc/pressure/memory", 512);
+    reader.run();
+    
+    return fromProc(reader.view(meminfo), reader.view(pressure));
+}
+
+#endif
@@ -0,0 +1,458 @@
+#include "package_count.h"
+#include "mapped_file.h"
+#include "result_cache.h"
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <sstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#include <cstdlib>
+#endif
+
+namespace {
+
+const char* const CACHE_NAME = "packages";
+
+// Cache entries are "<stamp> <count>"; the stamp is the database mtime
+bool loadCachedCount(const ResultCache& cache, const std::string& source,
+                     unsigned long long stamp, unsigned long long& count) {
+    std::string value;
+    if (!cache.load(source, -1, value)) {
+        return false;
+    }
+    
+    std::istringstream iss(value);
+    unsigned long long cachedStamp = 0;
+    if (!(iss >> cachedStamp >> count)) {
+        return false;
+    }
+    return cachedStamp == stamp;
+}
+
+void storeCachedCount(const ResultCache& cache, const std::string& source,
+                      unsigned long long stamp, unsigned long long count) {
+    cache.store(source, std::to_string(stamp) + " " + std::to_string(count));
+}
+
+uint32_t readBigEndian(const unsigned char* p, int bytes) {
+    uint32_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+// SQLite variable-length integer; returns the number of bytes consumed
+int readVarint(const unsigned char* p, const unsigned char* end, uint64_t& value) {
+    value = 0;
+    for (int i = 0; i < 9 && p + i < end; i++) {
+        if (i == 8) {
+            value = (value << 8) | p[i];
+            return 9;
+        }
+        value = (value << 7) | (p[i] & 0x7F);
+        if (!(p[i] & 0x80)) {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+// Read-only view of an SQLite database file, enough to count table rows
+struct SqliteFile {
+    const unsigned char* data;
+    size_t size;
+    size_t pageSize;
+    
+    const unsigned char* page(uint32_t number) const {
+        if (number == 0 || (static_cast<size_t>(number) - 1) * pageSize + pageSize > size) {
+            return nullptr;
+        }
+        return data + (static_cast<size_t>(number) - 1) * pageSize;
+    }
+    
+    // Page 1 starts with the 100-byte file header
+    const unsigned char* btreeHeader(uint32_t number) const {
+        const unsigned char* p = page(number);
+        return p && number == 1 ? p + 100 : p;
+    }
+    
+    // Visits every leaf cell of a table b-tree
+    template <typename F>
+    bool walkTable(uint32_t root, F onLeafPage, int depth = 0) const {
+        const unsigned char* header = btreeHeader(root);
+        const unsigned char* base = page(root);
+        if (!header || depth > 32) {
+            return false;
+        }
+        
+        uint8_t type = header[0];
+        uint32_t cells = readBigEndian(header + 3, 2);
+        
+        // The cell pointer array follows the 8-byte (leaf) or 12-byte
+        // (interior) page header and must end inside the page
+        size_t pointersEnd = static_cast<size_t>(header - base) + (type == 0x0D ? 8 : 12) + cells * 2;
+        if (pointersEnd > pageSize) {
+            return false;
+        }
+        
+        if (type == 0x0D) {
+            onLeafPage(base, header + 8, cells);
+            return true;
+        }
+        if (type != 0x05) {
+            return false;
+        }
+        
+        // Interior page: a child pointer per cell plus the right-most one
+        const unsigned char* pointers = header + 12;
+        for (uint32_t i = 0; i < cells; i++) {
+            uint32_t offset = readBigEndian(pointers + i * 2, 2);
+            if (offset + 4 > pageSize) return false;
+            if (!walkTable(readBigEndian(base + offset, 4), onLeafPage, depth + 1)) return false;
+        }
+        return walkTable(readBigEndian(header + 8, 4), onLeafPage, depth + 1);
+    }
+};
+
+#ifdef _WIN32
+
+struct UninstallRoot {
+    HKEY hive;
+    const char* path;
+};
+
+const UninstallRoot UNINSTALL_ROOTS[] = {
+    { HKEY_LOCAL_MACHINE, "SOFTWARE\\Microsoft\\Windows\\CurrentVersion\\Uninstall" },
+    { HKEY_LOCAL_MACHINE, "SOFTWARE\\WOW6432Node\\Microsoft\\Windows\\CurrentVersion\\Uninstall" },
+    { HKEY_CURRENT_USER, "SOFTWARE\\Microsoft\\Windows\\CurrentVersion\\Uninstall" },
+};
+
+bool hasRegistryValue(HKEY key, const char* valueName) {
+    return RegQueryValueEx(key, valueName, nullptr, nullptr, nullptr, nullptr) == ERROR_SUCCESS;
+}
+
+DWORD getRegistryDword(HKEY key, const char* valueName) {
+    DWORD value = 0;
+    DWORD size = sizeof(value);
+    if (RegQueryValueEx(key, valueName, nullptr, nullptr, reinterpret_cast<LPBYTE>(&value), &size) != ERROR_SUCCESS) {
+        return 0;
+    }
+    return value;
+}
+
+// Counts entries in [first, last) that Programs and Features would show:
+// named, not a system component and not an update of another entry
+unsigned long long countUninstallRange(const UninstallRoot& root, DWORD first, DWORD last) {
+    HKEY hKey;
+    if (RegOpenKeyEx(root.hive, root.path, 0, KEY_READ, &hKey) != ERROR_SUCCESS) {
+        return 0;
+    }
+    
+    unsigned long long count = 0;
+    char name[256];
+    for (DWORD index = first; index < last; index++) {
+        DWORD nameSize = sizeof(name);
+        if (RegEnumKeyEx(hKey, index, name, &nameSize, nullptr, nullptr, nullptr, nullptr) != ERROR_SUCCESS) {
+            break;
+        }
+        
+        HKEY hEntry;
+        if (RegOpenKeyEx(hKey, name, 0, KEY_READ, &hEntry) != ERROR_SUCCESS) {
+            continue;
+        }
+        if (hasRegistryValue(hEntry, "DisplayName") &&
+            getRegistryDword(hEntry, "SystemComponent") != 1 &&
+            !hasRegistryValue(hEntry, "ParentKeyName")) {
+            count++;
+        }
+        RegCloseKey(hEntry);
+    }
+    
+    RegCloseKey(hKey);
+    return count;
+}
+
+// Key last-write time changes whenever a subkey is added or removed
+bool uninstallRootStamp(const UninstallRoot& root, DWORD& subKeys, unsigned long long& stamp) {
+    HKEY hKey;
+    if (RegOpenKeyEx(root.hive, root.path, 0, KEY_READ, &hKey) != ERROR_SUCCESS) {
+        return false;
+    }
+    
+    FILETIME lastWrite;
+    bool ok = RegQueryInfoKey(hKey, nullptr, nullptr, nullptr, &subKeys, nullptr, nullptr,
+        nullptr, nullptr, nullptr, nullptr, &lastWrite) == ERROR_SUCCESS;
+    RegCloseKey(hKey);
+    
+    stamp = (static_cast<unsigned long long>(lastWrite.dwHighDateTime) << 32) | lastWrite.dwLowDateTime;
+    return ok;
+}
+
+#else
+
+bool fileStamp(const std::string& path, unsigned long long& stamp) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        return false;
+    }
+    stamp = static_cast<unsigned long long>(st.st_mtim.tv_sec) * 1000000000ULL +
+            static_cast<unsigned long long>(st.st_mtim.tv_nsec);
+    return true;
+}
+
+unsigned long long countSubdirectories(const std::string& path) {
+    DIR* dir = opendir(path.c_str());
+    if (!dir) {
+        return 0;
+    }
+    
+    unsigned long long count = 0;
+    while (dirent* entry = readdir(dir)) {
+        if (entry->d_name[0] != '.' && (entry->d_type == DT_DIR || entry->d_type == DT_UNKNOWN)) {
+            count++;
+        }
+    }
+    closedir(dir);
+    return count;
+}
+
+#endif
+
+}
+
+unsigned long long PackageCounter::countDpkgStatus(const char* data, size_t size) {
+    static const char STATUS[] = "Status: ";
+    static const char INSTALLED[] = " installed";
+    const size_t statusLength = sizeof(STATUS) - 1;
+    const size_t installedLength = sizeof(INSTALLED) - 1;
+    
+    unsigned long long count = 0;
+    const char* p = data;
+    const char* end = data + size;
+    
+    // memchr is vectorized by every C runtime worth using; the status file
+    // is walked line by line and only "Status:" lines are inspected
+    while (p < end) {
+        const char* newline = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+        const char* lineEnd = newline ? newline : end;
+        size_t length = static_cast<size_t>(lineEnd - p);
+        
+        if (length > statusLength + installedLength && p[0] == 'S' &&
+            std::memcmp(p, STATUS, statusLength) == 0 &&
+            std::memcmp(lineEnd - installedLength, INSTALLED, installedLength) == 0) {
+            count++;
+        }
+        
+        if (!newline) break;
+        p = newline + 1;
+    }
+    
+    return count;
+}
+
+unsigned long long PackageCounter::countSqliteTableRows(const char* data, size_t size, const std::string& table) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    if (size < 100 || std::memcmp(data, "SQLite format 3", 16) != 0) {
+        return 0;
+    }
+    
+    // Page sizes are powers of two from 512 to 65536; 1 stands for 65536
+    uint32_t pageSize = readBigEndian(bytes + 16, 2);
+    if (pageSize == 1) {
+        pageSize = 65536;
+    }
+    if (pageSize < 512 || (pageSize & (pageSize - 1)) != 0) {
+        return 0;
+    }
+    SqliteFile file = { bytes, size, pageSize };
+    
+    // Find the table's root page in sqlite_master (rooted at page 1);
+    // its records are (type, name, tbl_name, rootpage, sql)
+    uint32_t root = 0;
+    file.walkTable(1, [&](const unsigned char* base, const unsigned char* pointers, uint32_t cells) {
+        const unsigned char* pageEnd = base + file.pageSize;
+        for (uint32_t i = 0; i < cells && root == 0; i++) {
+            const unsigned char* p = base + readBigEndian(pointers + i * 2, 2);
+            uint64_t payloadSize = 0;
+            uint64_t rowid = 0;
+            uint64_t headerSize = 0;
+            p += readVarint(p, pageEnd, payloadSize);
+            p += readVarint(p, pageEnd, rowid);
+            
+            const unsigned char* record = p;
+            const unsigned char* headerEnd = record + readVarint(record, pageEnd, headerSize);
+            const unsigned char* headerStart = record + headerSize;
+            if (headerStart > pageEnd) continue;
+            
+            uint64_t serialTypes[4] = {};
+            const unsigned char* h = headerEnd;
+            for (int column = 0; column < 4 && h < headerStart; column++) {
+                h += readVarint(h, headerStart, serialTypes[column]);
+            }
+            
+            // Text columns have odd serial types >= 13
+            auto textLength = [](uint64_t serialType) {
+                return serialType >= 13 && (serialType & 1) ? (serialType - 13) / 2 : 0;
+            };
+            const unsigned char* value = headerStart;
+            uint64_t typeLength = textLength(serialTypes[0]);
+            uint64_t nameLength = textLength(serialTypes[1]);
+            uint64_t tableLength = textLength(serialTypes[2]);
+            const unsigned char* rootValue = value + typeLength + nameLength + tableLength;
+            if (rootValue + 4 > pageEnd) continue;
+            
+            if (typeLength == 5 && std::memcmp(value, "table", 5) == 0 &&
+                nameLength == table.size() && std::memcmp(value + typeLength, table.data(), nameLength) == 0) {
+                // Integer serial types 1-4 are 1, 2, 3 and 4 byte big-endian
+                if (serialTypes[3] >= 1 && serialTypes[3] <= 4) {
+                    root = readBigEndian(rootValue, static_cast<int>(serialTypes[3]));
+                }
+            }
+        }
+    });
+    
+    if (root == 0) {
+        return 0;
+    }
+    
+    unsigned long long rows = 0;
+    bool ok = file.walkTable(root, [&rows](const unsigned char*, const unsigned char*, uint32_t cells) {
+        rows += cells;
+    });
+    return ok ? rows : 0;
+}
+
+#ifdef _WIN32
+
+std::vector<PackageCount> PackageCounter::countAll() {
+    ResultCache cache(CACHE_NAME);
+    
+    // Large Uninstall keys hold thousands of subkeys; each one is split
+    // into index ranges that are enumerated on separate threads
+    const DWORD CHUNK = 256;
+    
+    struct PendingRoot {
+        std::string source;
+        unsigned long long stamp;
+        std::vector<std::future<unsigned long long>> jobs;
+    };
+    
+    unsigned long long total = 0;
+    std::vector<PendingRoot> pending;
+    
+    for (size_t r = 0; r < sizeof(UNINSTALL_ROOTS) / sizeof(UNINSTALL_ROOTS[0]); r++) {
+        const UninstallRoot& root = UNINSTALL_ROOTS[r];
+        std::string source = "uninstall-" + std::to_string(r);
+        
+        DWORD subKeys = 0;
+        unsigned long long stamp = 0;
+        if (!uninstallRootStamp(root, subKeys, stamp)) {
+            continue;
+        }
+        
+        unsigned long long cached = 0;
+        if (loadCachedCount(cache, source, stamp, cached)) {
+            total += cached;
+            continue;
+        }
+        
+        PendingRoot entry;
+        entry.source = source;
+        entry.stamp = stamp;
+        for (DWORD first = 0; first < subKeys; first += CHUNK) {
+            DWORD last = first + CHUNK < subKeys ? first + CHUNK : subKeys;
+            entry.jobs.push_back(std::async(std::launch::async, countUninstallRange, std::cref(root), first, last));
+        }
+        pending.push_back(std::move(entry));
+    }
+    
+    for (auto& entry : pending) {
+        unsigned long long count = 0;
+        for (auto& job : entry.jobs) {
+            count += job.get();
+        }
+        storeCachedCount(cache, entry.source, entry.stamp, count);
+        total += count;
+    }
+    
+    std::vector<PackageCount> counts;
+    if (total > 0) {
+        counts.push_back({ "registry", total });
+    }
+    return counts;
+}
+
+#else
+
+std::vector<PackageCount> PackageCounter::countAll() {
+    ResultCache cache(CACHE_NAME);
+    
+    struct Source {
+        std::string name;
+        unsigned long long stamp;
+        unsigned long long count;
+        std::future<unsigned long long> scan;
+    };
+    
+    const char* home = std::getenv("HOME");
+    std::string flatpakSystem = "/var/lib/flatpak/app";
+    std::string flatpakUser = home ? std::string(home) + "/.local/share/flatpak/app" : "";
+    
+    // Stat every database first; only the ones that changed since the
+    // cached count are scanned, concurrently
+    std::vector<Source> sources;
+    auto addSource = [&](const std::string& name, unsigned long long stamp, auto scan) {
+        Source source;
+        source.name = name;
+        source.stamp = stamp;
+        source.count = 0;
+        if (!loadCachedCount(cache, name, stamp, source.count)) {
+            source.scan = std::async(std::launch::async, scan);
+        }
+        sources.push_back(std::move(source));
+    };
+    
+    unsigned long long stamp = 0;
+    if (fileStamp("/var/lib/dpkg/status", stamp)) {
+        addSource("dpkg", stamp, [] {
+            MappedFile status("/var/lib/dpkg/status");
+            return status.valid() ? countDpkgStatus(status.data(), status.size()) : 0ULL;
+        });
+    }
+    if (fileStamp("/var/lib/rpm/rpmdb.sqlite", stamp)) {
+        addSource("rpm", stamp, [] {
+            MappedFile db("/var/lib/rpm/rpmdb.sqlite");
+            return db.valid() ? countSqliteTableRows(db.data(), db.size(), "Packages") : 0ULL;
+        });
+    }
+    
+    // Installing or removing an app changes the app directory's mtime
+    unsigned long long flatpakStamp = 0;
+    if (fileStamp(flatpakSystem, stamp)) flatpakStamp ^= stamp;
+    if (!flatpakUser.empty() && fileStamp(flatpakUser, stamp)) flatpakStamp ^= stamp * 31;
+    if (flatpakStamp != 0) {
+        addSource("flatpak", flatpakStamp, [flatpakSystem, flatpakUser] {
+            return countSubdirectories(flatpakSystem) + (flatpakUser.empty() ? 0 : countSubdirectories(flatpakUser));
+        });
+    }
+    
+    std::vector<PackageCount> counts;
+    for (auto& source : sources) {
+        if (source.scan.valid()) {
+            source.count = source.scan.get();
+            storeCachedCount(cache, source.name, source.stamp, source.count);
+        }
+        if (source.count > 0) {
+            counts.push_back({ source.name, source.count });
+        }
+    }
+    return counts;
+}
+
+#endif
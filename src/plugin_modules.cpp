@@ -0,0 +1,430 @@
+#include "plugin_modules.h"
+#include "winfetch_plugin.h"
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+struct PluginRunner::Slot {
+    std::mutex mutex;
+    std::condition_variable doneCondition;
+    bool finished = false;
+    bool ok = false;
+    bool fromCache = false;
+    bool cancelled = false;
+    std::string value;
+#ifdef _WIN32
+    HANDLE job = nullptr;
+#else
+    pid_t processGroup = -1;
+#endif
+};
+
+namespace {
+
+const int DEFAULT_TIMEOUT_MS = 2000;
+const size_t PLUGIN_BUFFER_SIZE = 1024;
+
+// Modules print a single banner line; keep the first non-empty one
+std::string firstLine(const std::string& output) {
+    std::istringstream stream(output);
+    std::string line;
+    while (std::getline(stream, line)) {
+        line.erase(0, line.find_first_not_of(" \t\r\n"));
+        line.erase(line.find_last_not_of(" \t\r\n") + 1);
+        if (!line.empty()) {
+            return line;
+        }
+    }
+    return "";
+}
+
+}
+
+PluginRunner::PluginRunner(const Config& config)
+    : modules(parseModules(config)),
+      timeout(config.getIntSetting("module_timeout_ms", DEFAULT_TIMEOUT_MS)),
+      cache("modules"),
+      started(false) {
+}
+
+PluginRunner::~PluginRunner() {
+    // Anything still running at this point is past its deadline
+    for (auto& slot : slots) {
+        std::lock_guard<std::mutex> lock(slot->mutex);
+        slot->cancelled = true;
+#ifdef _WIN32
+        if (slot->job) {
+            TerminateJobObject(slot->job, 1);
+        }
+#else
+        if (slot->processGroup > 0) {
+            kill(-slot->processGroup, SIGKILL);
+        }
+#endif
+    }
+}
+
+std::vector<PluginModule> PluginRunner::parseModules(const Config& config) {
+    std::map<std::string, PluginModule> byName;
+    const std::string prefix = "module.";
+    
+    for (const auto& setting : config.getSettings()) {
+        const std::string& key = setting.first;
+        if (key.compare(0, prefix.size(), prefix) != 0) {
+            continue;
+        }
+        
+        size_t dot = key.rfind('.');
+        if (dot <= prefix.size()) {
+            continue;
+        }
+        
+        std::string name = key.substr(prefix.size(), dot - prefix.size());
+        std::string field = key.substr(dot + 1);
+        
+        PluginModule& module = byName[name];
+        if (module.name.empty()) {
+            module.name = name;
+            module.label = name;
+        }
+        
+        if (field == "label") {
+            module.label = setting.second;
+        } else if (field == "command") {
+            module.command = setting.second;
+        } else if (field == "library") {
+            module.library = setting.second;
+        } else if (field == "ttl") {
+            module.ttlSeconds = config.getIntSetting(key, 0);
+        }
+    }
+    
+    // Drop entries that have nothing to run
+    std::vector<PluginModule> runnable;
+    for (const auto& entry : byName) {
+        if (!entry.second.command.empty() || !entry.second.library.empty()) {
+            runnable.push_back(entry.second);
+        }
+    }
+    return runnable;
+}
+
+std::string PluginRunner::cacheKey(const PluginModule& module) {
+    // Include the source so editing the command invalidates the entry
+    std::ostringstream oss;
+    oss << module.name << "-" << std::hex << std::hash<std::string>()(module.command + "|" + module.library);
+    return oss.str();
+}
+
+void PluginRunner::start() {
+    if (started) {
+        return;
+    }
+    started = true;
+    deadline = std::chrono::steady_clock::now() + timeout;
+    
+    for (const auto& module : modules) {
+        auto slot = std::make_shared<Slot>();
+        slots.push_back(slot);
+        
+        std::string cached;
+        if (module.ttlSeconds > 0 && cache.load(cacheKey(module), module.ttlSeconds, cached)) {
+            slot->finished = true;
+            slot->ok = true;
+            slot->fromCache = true;
+            slot->value = cached;
+            continue;
+        }
+        
+        // Detached so a hung collector library can never block exit
+        std::thread(runModule, module, slot).detach();
+    }
+}
+
+std::vector<ModuleResult> PluginRunner::collect() {
+    start();
+    
+    std::vector<ModuleResult> results;
+    for (size_t i = 0; i < modules.size(); i++) {
+        const PluginModule& module = modules[i];
+        Slot& slot = *slots[i];
+        
+        ModuleResult result;
+        result.name = module.name;
+        result.label = module.label;
+        
+        std::unique_lock<std::mutex> lock(slot.mutex);
+        bool finished = slot.doneCondition.wait_until(lock, deadline, [&slot] { return slot.finished; });
+        
+        if (finished && slot.ok) {
+            result.value = slot.value;
+            result.fromCache = slot.fromCache;
+            if (!slot.fromCache && module.ttlSeconds > 0) {
+                cache.store(cacheKey(module), slot.value);
+            }
+        } else {
+            if (!finished) {
+                slot.cancelled = true;
+                result.timedOut = true;
+#ifdef _WIN32
+                if (slot.job) {
+                    TerminateJobObject(slot.job, 1);
+                }
+#else
+                if (slot.processGroup > 0) {
+                    kill(-slot.processGroup, SIGKILL);
+                }
+#endif
+            }
+            
+            // A stale value beats no value at all
+            std::string stale;
+            if (cache.load(cacheKey(module), -1, stale)) {
+                result.value = stale;
+                result.fromCache = true;
+            } else {
+                result.value = result.timedOut ? "Timed out" : "Unavailable";
+            }
+        }
+        
+        results.push_back(result);
+    }
+    
+    return results;
+}
+
+void PluginRunner::runModule(const PluginModule& module, std::shared_ptr<Slot> slot) {
+    std::string output;
+    bool ok = false;
+    
+    if (!module.command.empty()) {
+        ok = runCommand(module.command, slot, output);
+    } else {
+        ok = runLibrary(module, output);
+    }
+    
+    std::lock_guard<std::mutex> lock(slot->mutex);
+    slot->value = firstLine(output);
+    slot->ok = ok && !slot->cancelled && !slot->value.empty();
+    slot->finished = true;
+    slot->doneCondition.notify_all();
+}
+
+#ifdef _WIN32
+
+bool PluginRunner::runCommand(const std::string& command, std::shared_ptr<Slot> slot, std::string& output) {
+    SECURITY_ATTRIBUTES sa;
+    sa.nLength = sizeof(sa);
+    sa.lpSecurityDescriptor = nullptr;
+    sa.bInheritHandle = TRUE;
+    
+    HANDLE readPipe = nullptr;
+    HANDLE writePipe = nullptr;
+    if (!CreatePipe(&readPipe, &writePipe, &sa, 0)) {
+        return false;
+    }
+    SetHandleInformation(readPipe, HANDLE_FLAG_INHERIT, 0);
+    
+    // The job lets a timeout kill the whole process tree, not just cmd.exe
+    HANDLE job = CreateJobObject(nullptr, nullptr);
+    if (job) {
+        JOBOBJECT_EXTENDED_LIMIT_INFORMATION limits;
+        ZeroMemory(&limits, sizeof(limits));
+        limits.BasicLimitInformation.LimitFlags = JOB_OBJECT_LIMIT_KILL_ON_JOB_CLOSE;
+        SetInformationJobObject(job, JobObjectExtendedLimitInformation, &limits, sizeof(limits));
+    }
+    
+    // Modules start concurrently; without an explicit handle list every
+    // child would inherit the other modules' pipe ends and keep their
+    // readers from seeing end of file
+    SIZE_T attributeSize = 0;
+    InitializeProcThreadAttributeList(nullptr, 1, 0, &attributeSize);
+    std::vector<char> attributeBuffer(attributeSize);
+    LPPROC_THREAD_ATTRIBUTE_LIST attributes = reinterpret_cast<LPPROC_THREAD_ATTRIBUTE_LIST>(attributeBuffer.data());
+    if (!InitializeProcThreadAttributeList(attributes, 1, 0, &attributeSize)) {
+        CloseHandle(readPipe);
+        CloseHandle(writePipe);
+        if (job) CloseHandle(job);
+        return false;
+    }
+    
+    STARTUPINFOEXA si;
+    ZeroMemory(&si, sizeof(si));
+    si.StartupInfo.cb = sizeof(si);
+    si.StartupInfo.dwFlags = STARTF_USESTDHANDLES;
+    si.StartupInfo.hStdOutput = writePipe;
+    si.StartupInfo.hStdError = nullptr;
+    si.StartupInfo.hStdInput = nullptr;
+    si.lpAttributeList = attributes;
+    
+    PROCESS_INFORMATION pi;
+    ZeroMemory(&pi, sizeof(pi));
+    
+    std::string commandLine = "cmd.exe /C " + command;
+    std::vector<char> buffer(commandLine.begin(), commandLine.end());
+    buffer.push_back('\0');
+    
+    BOOL created = UpdateProcThreadAttribute(attributes, 0, PROC_THREAD_ATTRIBUTE_HANDLE_LIST,
+            &writePipe, sizeof(writePipe), nullptr, nullptr) &&
+        CreateProcessA(nullptr, buffer.data(), nullptr, nullptr, TRUE,
+            CREATE_NO_WINDOW | CREATE_SUSPENDED | EXTENDED_STARTUPINFO_PRESENT, nullptr, nullptr, &si.StartupInfo, &pi);
+    DeleteProcThreadAttributeList(attributes);
+    CloseHandle(writePipe);
+    
+    if (!created) {
+        CloseHandle(readPipe);
+        if (job) CloseHandle(job);
+        return false;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(slot->mutex);
+        if (job) {
+            AssignProcessToJobObject(job, pi.hProcess);
+            slot->job = job;
+        }
+        if (slot->cancelled) {
+            TerminateProcess(pi.hProcess, 1);
+        }
+    }
+    ResumeThread(pi.hThread);
+    CloseHandle(pi.hThread);
+    
+    char chunk[512];
+    DWORD bytesRead = 0;
+    while (ReadFile(readPipe, chunk, sizeof(chunk), &bytesRead, nullptr) && bytesRead > 0) {
+        output.append(chunk, bytesRead);
+    }
+    CloseHandle(readPipe);
+    
+    WaitForSingleObject(pi.hProcess, INFINITE);
+    DWORD exitCode = 1;
+    GetExitCodeProcess(pi.hProcess, &exitCode);
+    CloseHandle(pi.hProcess);
+    
+    {
+        std::lock_guard<std::mutex> lock(slot->mutex);
+        slot->job = nullptr;
+    }
+    if (job) CloseHandle(job);
+    
+    return exitCode == 0;
+}
+
+bool PluginRunner::runLibrary(const PluginModule& module, std::string& output) {
+    // Never unloaded: a timed-out call may still be executing inside it
+    HMODULE library = LoadLibraryA(module.library.c_str());
+    if (!library) {
+        return false;
+    }
+    
+    auto abiVersion = reinterpret_cast<winfetch_plugin_abi_version_fn>(
+        GetProcAddress(library, "winfetch_plugin_abi_version"));
+    auto collectFn = reinterpret_cast<winfetch_plugin_collect_fn>(
+        GetProcAddress(library, "winfetch_plugin_collect"));
+    if (!abiVersion || !collectFn || abiVersion() != WINFETCH_PLUGIN_ABI_VERSION) {
+        return false;
+    }
+    
+    char buffer[PLUGIN_BUFFER_SIZE] = {};
+    if (collectFn(module.name.c_str(), buffer, sizeof(buffer)) != 0) {
+        return false;
+    }
+    buffer[sizeof(buffer) - 1] = '\0';
+    output = buffer;
+    return true;
+}
+
+#else
+
+bool PluginRunner::runCommand(const std::string& command, std::shared_ptr<Slot> slot, std::string& output) {
+    // Close-on-exec, so children forked concurrently by other modules do
+    // not inherit this pipe; dup2 clears the flag on our child's stdout
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) != 0) {
+        return false;
+    }
+    
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    
+    if (pid == 0) {
+        // Own process group, so a timeout kills the command's children too
+        setpgid(0, 0);
+        dup2(fds[1], STDOUT_FILENO);
+        close(fds[0]);
+        close(fds[1]);
+        execl("/bin/sh", "sh", "-c", command.c_str(), static_cast<char*>(nullptr));
+        _exit(127);
+    }
+    
+    close(fds[1]);
+    setpgid(pid, pid);
+    {
+        std::lock_guard<std::mutex> lock(slot->mutex);
+        slot->processGroup = pid;
+        if (slot->cancelled) {
+            kill(-pid, SIGKILL);
+        }
+    }
+    
+    char chunk[512];
+    ssize_t bytesRead = 0;
+    while ((bytesRead = read(fds[0], chunk, sizeof(chunk))) > 0) {
+        output.append(chunk, static_cast<size_t>(bytesRead));
+    }
+    close(fds[0]);
+    
+    int status = 0;
+    waitpid(pid, &status, 0);
+    
+    {
+        std::lock_guard<std::mutex> lock(slot->mutex);
+        slot->processGroup = -1;
+    }
+    
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+bool PluginRunner::runLibrary(const PluginModule& module, std::string& output) {
+    // Never unloaded: a timed-out call may still be executing inside it
+    void* library = dlopen(module.library.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!library) {
+        return false;
+    }
+    
+    auto abiVersion = reinterpret_cast<winfetch_plugin_abi_version_fn>(
+        dlsym(library, "winfetch_plugin_abi_version"));
+    auto collectFn = reinterpret_cast<winfetch_plugin_collect_fn>(
+        dlsym(library, "winfetch_plugin_collect"));
+    if (!abiVersion || !collectFn || abiVersion() != WINFETCH_PLUGIN_ABI_VERSION) {
+        return false;
+    }
+    
+    char buffer[PLUGIN_BUFFER_SIZE] = {};
+    if (collectFn(module.name.c_str(), buffer, sizeof(buffer)) != 0) {
+        return false;
+    }
+    buffer[sizeof(buffer) - 1] = '\0';
+    output = buffer;
+    return true;
+}
+
+#endif
@@ -0,0 +1,127 @@
+#include "result_cache.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Numbers the temporary files of one process
+std::atomic<unsigned long long> tmpSequence(0);
+
+long long processId() {
+#ifdef _WIN32
+    return _getpid();
+#else
+    return getpid();
+#endif
+}
+
+long long nowSeconds() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+}
+
+ResultCache::ResultCache(const std::string& name) {
+    directory = cacheRoot() + "/" + name;
+}
+
+std::string ResultCache::cacheRoot() {
+#ifdef _WIN32
+    const char* base = std::getenv("LOCALAPPDATA");
+    if (base && *base) {
+        return std::string(base) + "\\winfetch\\cache";
+    }
+    return ".\\winfetch-cache";
+#else
+    const char* xdg = std::getenv("XDG_CACHE_HOME");
+    if (xdg && *xdg) {
+        return std::string(xdg) + "/winfetch";
+    }
+    const char* home = std::getenv("HOME");
+    if (home && *home) {
+        return std::string(home) + "/.cache/winfetch";
+    }
+    return "/tmp/winfetch-cache";
+#endif
+}
+
+std::string ResultCache::pathFor(const std::string& key) const {
+    // Keys come from config names; keep them safe to use as file names
+    std::string safe;
+    for (char c : key) {
+        bool ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                  (c >= '0' && c <= '9') || c == '-' || c == '_' || c == '.';
+        safe += ok ? c : '_';
+    }
+    return directory + "/" + safe;
+}
+
+bool ResultCache::load(const std::string& key, long long maxAgeSeconds, std::string& value) const {
+    std::ifstream file(pathFor(key), std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    
+    std::string header;
+    if (!std::getline(file, header)) {
+        return false;
+    }
+    
+    long long written = 0;
+    try {
+        written = std::stoll(header);
+    } catch (const std::exception&) {
+        return false;
+    }
+    
+    if (maxAgeSeconds >= 0 && nowSeconds() - written > maxAgeSeconds) {
+        return false;
+    }
+    
+    std::ostringstream oss;
+    oss << file.rdbuf();
+    value = oss.str();
+    return true;
+}
+
+void ResultCache::store(const std::string& key, const std::string& value) const {
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    if (ec) {
+        return;
+    }
+    
+    // Write to a temporary file first so concurrent shells never see a
+    // half-written entry. Every writer gets its own temporary file, named
+    // after its process and a per-process counter, so two writers of the
+    // same key never truncate each other's file.
+    std::string path = pathFor(key);
+    std::string tmpPath = path + "." + std::to_string(processId()) + "." + std::to_string(tmpSequence++) + ".tmp";
+    bool written = false;
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            return;
+        }
+        file << nowSeconds() << "\n" << value;
+        file.flush();
+        written = file.good();
+    }
+    if (written) {
+        std::filesystem::rename(tmpPath, path, ec);
+    }
+    if (!written || ec) {
+        std::filesystem::remove(tmpPath, ec);
+    }
+}
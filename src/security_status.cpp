@@ -0,0 +1,449 @@
+#include "security_status.h"
+#include "data_provider.h"
+#include <condition_variable>
+#include <ctime>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <slpublic.h>
+#include <wscapi.h>
+#include <wuapi.h>
+
+#pragma comment(lib, "slc.lib")
+#pragma comment(lib, "wscapi.lib")
+#pragma comment(lib, "wuguid.lib")
+#pragma comment(lib, "ole32.lib")
+#pragma comment(lib, "oleaut32.lib")
+#endif
+
+struct SecurityRunner::Slot {
+    std::mutex mutex;
+    std::condition_variable doneCondition;
+    bool finished = false;
+    bool ok = false;
+    std::string facts;
+};
+
+namespace {
+
+// How long each kind of answer stays good; activation barely ever changes,
+// Defender state is what dashboards watch most closely
+const long long ACTIVATION_TTL = 24 * 60 * 60;
+const long long DEFENDER_TTL = 15 * 60;
+const long long UPDATES_TTL = 60 * 60;
+
+enum Section { SECTION_ACTIVATION, SECTION_DEFENDER, SECTION_UPDATES, SECTION_COUNT };
+
+const char* const SECTION_KEYS[SECTION_COUNT] = { "activation", "defender", "updates" };
+const long long SECTION_TTLS[SECTION_COUNT] = { ACTIVATION_TTL, DEFENDER_TTL, UPDATES_TTL };
+
+// Facts are cached raw, not formatted, so "3 hours ago" is computed at
+// display time instead of going stale in the cache
+std::string serialize(const ActivationFacts& facts) {
+    return std::to_string(facts.status) + " " + std::to_string(facts.graceMinutes);
+}
+
+std::string serialize(const DefenderFacts& facts) {
+    return std::to_string(facts.health) + " " + std::to_string(facts.realTime) + " " + facts.signatureVersion;
+}
+
+std::string serialize(const UpdateFacts& facts) {
+    return std::to_string(facts.lastSearch) + " " + std::to_string(facts.lastInstall) + " " +
+        (facts.rebootRequired ? "1" : "0");
+}
+
+bool parse(const std::string& text, ActivationFacts& facts) {
+    std::istringstream stream(text);
+    return static_cast<bool>(stream >> facts.status >> facts.graceMinutes);
+}
+
+bool parse(const std::string& text, DefenderFacts& facts) {
+    std::istringstream stream(text);
+    if (!(stream >> facts.health >> facts.realTime)) {
+        return false;
+    }
+    stream >> facts.signatureVersion;
+    return true;
+}
+
+bool parse(const std::string& text, UpdateFacts& facts) {
+    std::istringstream stream(text);
+    int reboot = 0;
+    if (!(stream >> facts.lastSearch >> facts.lastInstall >> reboot)) {
+        return false;
+    }
+    facts.rebootRequired = reboot != 0;
+    return true;
+}
+
+bool query(SecurityProvider& provider, int section, std::string& facts) {
+    switch (section) {
+        case SECTION_ACTIVATION: {
+            ActivationFacts activation;
+            if (!provider.queryActivation(activation)) return false;
+            facts = serialize(activation);
+            return true;
+        }
+        case SECTION_DEFENDER: {
+            DefenderFacts defender;
+            if (!provider.queryDefender(defender)) return false;
+            facts = serialize(defender);
+            return true;
+        }
+        case SECTION_UPDATES: {
+            UpdateFacts updates;
+            if (!provider.queryUpdates(updates)) return false;
+            facts = serialize(updates);
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+std::string format(int section, const std::string& text) {
+    switch (section) {
+        case SECTION_ACTIVATION: {
+            ActivationFacts facts;
+            return parse(text, facts) ? SecurityRunner::formatActivation(facts) : "Unknown";
+        }
+        case SECTION_DEFENDER: {
+            DefenderFacts facts;
+            return parse(text, facts) ? SecurityRunner::formatDefender(facts) : "Unknown";
+        }
+        case SECTION_UPDATES: {
+            UpdateFacts facts;
+            return parse(text, facts) ? SecurityRunner::formatUpdates(facts, std::time(nullptr)) : "Unknown";
+        }
+        default:
+            return "Unknown";
+    }
+}
+
+std::string plural(long long count, const char* unit) {
+    return std::to_string(count) + " " + unit + (count == 1 ? "" : "s");
+}
+
+std::string ago(long long seconds) {
+    if (seconds < 60 * 60) {
+        return plural(seconds / 60, "minute") + " ago";
+    }
+    if (seconds < 48 * 60 * 60) {
+        return plural(seconds / (60 * 60), "hour") + " ago";
+    }
+    return plural(seconds / (24 * 60 * 60), "day") + " ago";
+}
+
+// Numeric half of DefenderFacts, so it can go through fetchStruct
+struct DefenderState {
+    int health;
+    int realTime;
+};
+
+#ifdef _WIN32
+
+// The Windows application ID every Windows SKU is licensed under
+const SLID WINDOWS_APP_ID = { 0x55c92734, 0xd682, 0x4d71, { 0x98, 0x3e, 0xd6, 0xec, 0x3f, 0x16, 0x05, 0x9f } };
+
+bool liveActivation(ActivationFacts& facts) {
+    HSLC slc = nullptr;
+    if (FAILED(SLOpen(&slc))) {
+        return false;
+    }
+    
+    UINT count = 0;
+    SL_LICENSING_STATUS* statuses = nullptr;
+    HRESULT hr = SLGetLicensingStatusInformation(slc, &WINDOWS_APP_ID, nullptr, nullptr, &count, &statuses);
+    if (SUCCEEDED(hr)) {
+        // Every edition the image can become has an entry; the installed
+        // one is the best of them (licensed > grace > notification)
+        const int RANK[] = { 0, 3, 2, 1 };
+        facts.status = SL_LICENSING_STATUS_UNLICENSED;
+        for (UINT i = 0; i < count; i++) {
+            int status = statuses[i].eStatus;
+            if (status >= 0 && status <= 3 && RANK[status] > RANK[facts.status]) {
+                facts.status = status;
+                facts.graceMinutes = statuses[i].dwGraceTime;
+            }
+        }
+        LocalFree(statuses);
+    }
+    
+    SLClose(slc);
+    return SUCCEEDED(hr);
+}
+
+bool liveDefender(DefenderState& state) {
+    // Security Center reports on whichever antivirus is registered
+    WSC_SECURITY_PROVIDER_HEALTH health;
+    if (FAILED(WscGetSecurityProviderHealth(WSC_SECURITY_PROVIDER_ANTIVIRUS, &health))) {
+        return false;
+    }
+    state.health = static_cast<int>(health);
+    state.realTime = -1;
+    
+    // DisableRealtimeMonitoring only exists once real-time protection was turned off
+    HKEY key;
+    if (RegOpenKeyExA(HKEY_LOCAL_MACHINE, "SOFTWARE\\Microsoft\\Windows Defender\\Real-Time Protection",
+        0, KEY_READ, &key) == ERROR_SUCCESS) {
+        DWORD disabled = 0;
+        DWORD size = sizeof(disabled);
+        bool present = RegQueryValueExA(key, "DisableRealtimeMonitoring", nullptr, nullptr,
+            reinterpret_cast<LPBYTE>(&disabled), &size) == ERROR_SUCCESS;
+        state.realTime = present && disabled ? 0 : 1;
+        RegCloseKey(key);
+    }
+    return true;
+}
+
+std::string liveSignatureVersion() {
+    char version[64];
+    DWORD size = sizeof(version);
+    if (RegGetValueA(HKEY_LOCAL_MACHINE, "SOFTWARE\\Microsoft\\Windows Defender\\Signature Updates",
+        "AVSignatureVersion", RRF_RT_REG_SZ, nullptr, version, &size) != ERROR_SUCCESS) {
+        return "";
+    }
+    return version;
+}
+
+// Windows Update reports OLE automation dates in UTC
+long long variantDateToUnix(const VARIANT& value) {
+    if (value.vt != VT_DATE || value.date <= 0) {
+        return 0;
+    }
+    return static_cast<long long>((value.date - 25569.0) * 86400.0);
+}
+
+bool liveUpdates(UpdateFacts& facts) {
+    HRESULT init = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+    bool ok = false;
+    
+    IAutomaticUpdates2* updates = nullptr;
+    if (SUCCEEDED(CoCreateInstance(CLSID_AutoUpdate, nullptr, CLSCTX_ALL, IID_IAutomaticUpdates2,
+        reinterpret_cast<void**>(&updates)))) {
+        IAutomaticUpdatesResults* results = nullptr;
+        if (SUCCEEDED(updates->get_Results(&results))) {
+            VARIANT search;
+            VARIANT install;
+            VariantInit(&search);
+            VariantInit(&install);
+            if (SUCCEEDED(results->get_LastSearchSuccessDate(&search))) {
+                facts.lastSearch = variantDateToUnix(search);
+            }
+            if (SUCCEEDED(results->get_LastInstallationSuccessDate(&install))) {
+                facts.lastInstall = variantDateToUnix(install);
+            }
+            VariantClear(&search);
+            VariantClear(&install);
+            results->Release();
+            ok = true;
+        }
+        updates->Release();
+    }
+    
+    // This key exists while installed updates wait for a restart
+    HKEY key;
+    if (RegOpenKeyExA(HKEY_LOCAL_MACHINE, "SOFTWARE\\Microsoft\\Windows\\CurrentVersion\\WindowsUpdate\\Auto Update\\RebootRequired",
+        0, KEY_READ, &key) == ERROR_SUCCESS) {
+        facts.rebootRequired = true;
+        RegCloseKey(key);
+    }
+    
+    if (SUCCEEDED(init)) {
+        CoUninitialize();
+    }
+    return ok;
+}
+
+#endif
+
+// Goes through DataProvider so recorded answers replay on any platform
+class SystemSecurityProvider : public SecurityProvider {
+public:
+    bool queryActivation(ActivationFacts& facts) override {
+        return DataProvider::instance().fetchStruct<ActivationFacts>("security", "activation", facts, [](ActivationFacts& live) {
+#ifdef _WIN32
+            return liveActivation(live);
+#else
+            (void)live;
+            return false;
+#endif
+        });
+    }
+    
+    bool queryDefender(DefenderFacts& facts) override {
+        DataProvider& provider = DataProvider::instance();
+        DefenderState state;
+        if (!provider.fetchStruct<DefenderState>("security", "defender", state, [](DefenderState& live) {
+#ifdef _WIN32
+                return liveDefender(live);
+#else
+                (void)live;
+                return false;
+#endif
+            })) {
+            return false;
+        }
+        
+        facts.health = state.health;
+        facts.realTime = state.realTime;
+        facts.signatureVersion = provider.fetch("security", "signature_version", []() {
+#ifdef _WIN32
+            return liveSignatureVersion();
+#else
+            return std::string();
+#endif
+        });
+        return true;
+    }
+    
+    bool queryUpdates(UpdateFacts& facts) override {
+        return DataProvider::instance().fetchStruct<UpdateFacts>("security", "updates", facts, [](UpdateFacts& live) {
+#ifdef _WIN32
+            return liveUpdates(live);
+#else
+            (void)live;
+            return false;
+#endif
+        });
+    }
+};
+
+}
+
+std::shared_ptr<SecurityProvider> SecurityProvider::system() {
+    return std::make_shared<SystemSecurityProvider>();
+}
+
+SecurityRunner::SecurityRunner(std::shared_ptr<SecurityProvider> provider, std::chrono::milliseconds timeout,
+                               std::shared_ptr<const ResultCache> cache)
+    : provider(std::move(provider)),
+      timeout(timeout),
+      cache(std::move(cache)),
+      started(false) {
+}
+
+std::shared_ptr<const ResultCache> SecurityRunner::systemCache() {
+    DataProvider& provider = DataProvider::instance();
+    if (provider.recording() || provider.replaying()) {
+        return nullptr;
+    }
+    return std::make_shared<const ResultCache>("security");
+}
+
+SecurityRunner::~SecurityRunner() {
+}
+
+void SecurityRunner::start() {
+    if (started) {
+        return;
+    }
+    started = true;
+    deadline = std::chrono::steady_clock::now() + timeout;
+    
+    for (int section = 0; section < SECTION_COUNT; section++) {
+        auto slot = std::make_shared<Slot>();
+        slots.push_back(slot);
+        
+        std::string cached;
+        if (cache && cache->load(SECTION_KEYS[section], SECTION_TTLS[section], cached)) {
+            slot->finished = true;
+            slot->ok = true;
+            slot->facts = cached;
+            continue;
+        }
+        
+        // Detached so a wedged licensing or update service never blocks
+        // exit; a late answer still lands in the cache for the next run
+        std::thread([section, slot](std::shared_ptr<SecurityProvider> provider, std::shared_ptr<const ResultCache> cache) {
+            std::string facts;
+            bool ok = query(*provider, section, facts);
+            if (ok && cache) {
+                cache->store(SECTION_KEYS[section], facts);
+            }
+            
+            std::lock_guard<std::mutex> lock(slot->mutex);
+            slot->facts = facts;
+            slot->ok = ok;
+            slot->finished = true;
+            slot->doneCondition.notify_all();
+        }, provider, cache).detach();
+    }
+}
+
+SecurityReport SecurityRunner::collect() {
+    start();
+    
+    std::string values[SECTION_COUNT];
+    for (int section = 0; section < SECTION_COUNT; section++) {
+        Slot& slot = *slots[section];
+        std::string facts;
+        
+        std::unique_lock<std::mutex> lock(slot.mutex);
+        bool finished = slot.doneCondition.wait_until(lock, deadline, [&slot] { return slot.finished; });
+        if (finished && slot.ok) {
+            facts = slot.facts;
+        } else {
+            // A stale answer beats no answer at all
+            if (cache) {
+                cache->load(SECTION_KEYS[section], -1, facts);
+            }
+        }
+        
+        values[section] = facts.empty() ? "Unknown" : format(section, facts);
+    }
+    
+    SecurityReport report;
+    report.activation = values[SECTION_ACTIVATION];
+    report.defender = values[SECTION_DEFENDER];
+    report.update = values[SECTION_UPDATES];
+    return report;
+}
+
+std::string SecurityRunner::formatActivation(const ActivationFacts& facts) {
+    switch (facts.status) {
+        case 0: return "Not activated";
+        case 1: return "Activated";
+        case 2: return "Grace period (" + plural(facts.graceMinutes / (24 * 60), "day") + " left)";
+        case 3: return "Not activated (notification mode)";
+        default: return "Unknown";
+    }
+}
+
+std::string SecurityRunner::formatDefender(const DefenderFacts& facts) {
+    std::string state;
+    switch (facts.health) {
+        case 0: state = "Protected"; break;
+        case 1: state = "Not monitored"; break;
+        case 2: state = "At risk"; break;
+        case 3: state = "Snoozed"; break;
+        default: return "Unknown";
+    }
+    
+    std::string details;
+    if (facts.realTime >= 0) {
+        details = facts.realTime ? "real-time on" : "real-time off";
+    }
+    if (!facts.signatureVersion.empty()) {
+        details += (details.empty() ? "" : ", ") + std::string("signatures ") + facts.signatureVersion;
+    }
+    return details.empty() ? state : state + " (" + details + ")";
+}
+
+std::string SecurityRunner::formatUpdates(const UpdateFacts& facts, long long now) {
+    std::string text;
+    if (facts.lastInstall > 0) {
+        text = "Installed " + ago(now > facts.lastInstall ? now - facts.lastInstall : 0);
+    }
+    if (facts.lastSearch > 0) {
+        text += (text.empty() ? "Checked " : ", checked ") + ago(now > facts.lastSearch ? now - facts.lastSearch : 0);
+    }
+    if (facts.rebootRequired) {
+        text += text.empty() ? "Restart pending" : ", restart pending";
+    }
+    return text.empty() ? "Unknown" : text;
+}
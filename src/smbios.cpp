@@ -0,0 +1,300 @@
+#include "smbios.h"
+#include "data_provider.h"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+namespace {
+
+const uint8_t TYPE_BIOS = 0;
+const uint8_t TYPE_BASEBOARD = 2;
+const uint8_t TYPE_CHASSIS = 3;
+const uint8_t TYPE_MEMORY_DEVICE = 17;
+const uint8_t TYPE_END_OF_TABLE = 127;
+
+// Windows prefixes the table with a RawSMBIOSData header
+const size_t RSMB_HEADER_SIZE = 8;
+
+// One structure: the formatted area followed by its string set
+struct Structure {
+    const uint8_t* formatted;
+    uint8_t length;
+    const char* strings;
+    const char* stringsEnd;
+
+    uint8_t byteAt(size_t offset) const {
+        return offset < length ? formatted[offset] : 0;
+    }
+
+    uint16_t wordAt(size_t offset) const {
+        if (offset + 2 > length) return 0;
+        uint16_t value;
+        std::memcpy(&value, formatted + offset, sizeof(value));
+        return value;
+    }
+
+    uint32_t dwordAt(size_t offset) const {
+        if (offset + 4 > length) return 0;
+        uint32_t value;
+        std::memcpy(&value, formatted + offset, sizeof(value));
+        return value;
+    }
+
+    // Strings are referenced by 1-based index; 0 means "not present"
+    std::string_view stringAt(size_t offset) const {
+        uint8_t index = byteAt(offset);
+        if (index == 0) return std::string_view();
+        
+        const char* p = strings;
+        for (uint8_t i = 1; p < stringsEnd && *p; i++) {
+            size_t len = strnlen(p, static_cast<size_t>(stringsEnd - p));
+            if (i == index) {
+                std::string_view value(p, len);
+                // Firmware often pads strings with spaces
+                while (!value.empty() && value.back() == ' ') {
+                    value.remove_suffix(1);
+                }
+                return value;
+            }
+            p += len + 1;
+        }
+        return std::string_view();
+    }
+};
+
+const char* memoryTypeName(uint8_t type) {
+    switch (type) {
+        case 0x03: return "DRAM";
+        case 0x0F: return "SDRAM";
+        case 0x12: return "DDR";
+        case 0x13: return "DDR2";
+        case 0x14: return "DDR2 FB-DIMM";
+        case 0x18: return "DDR3";
+        case 0x1A: return "DDR4";
+        case 0x1B: return "LPDDR";
+        case 0x1C: return "LPDDR2";
+        case 0x1D: return "LPDDR3";
+        case 0x1E: return "LPDDR4";
+        case 0x1F: return "Logical non-volatile";
+        case 0x20: return "HBM";
+        case 0x21: return "HBM2";
+        case 0x22: return "DDR5";
+        case 0x23: return "LPDDR5";
+        case 0x24: return "HBM3";
+        default: return "Unknown";
+    }
+}
+
+const char* chassisTypeName(uint8_t type) {
+    static const char* const names[] = {
+        "Unknown", "Other", "Unknown", "Desktop", "Low Profile Desktop",
+        "Pizza Box", "Mini Tower", "Tower", "Portable", "Laptop",
+        "Notebook", "Hand Held", "Docking Station", "All in One", "Sub Notebook",
+        "Space-saving", "Lunch Box", "Main Server Chassis", "Expansion Chassis", "SubChassis",
+        "Bus Expansion Chassis", "Peripheral Chassis", "RAID Chassis", "Rack Mount Chassis", "Sealed-case PC",
+        "Multi-system Chassis", "Compact PCI", "Advanced TCA", "Blade", "Blade Enclosure",
+        "Tablet", "Convertible", "Detachable", "IoT Gateway", "Embedded PC",
+        "Mini PC", "Stick PC"
+    };
+    // Bit 7 is the chassis lock flag
+    type &= 0x7F;
+    if (type < sizeof(names) / sizeof(names[0])) {
+        return names[type];
+    }
+    return "Unknown";
+}
+
+uint64_t memoryDeviceSize(const Structure& s) {
+    uint16_t size = s.wordAt(0x0C);
+    if (size == 0 || size == 0xFFFF) {
+        return 0;
+    }
+    if (size == 0x7FFF) {
+        // Extended Size, in MB, for modules of 32 GB and up
+        return static_cast<uint64_t>(s.dwordAt(0x1C) & 0x7FFFFFFF) << 20;
+    }
+    if (size & 0x8000) {
+        return static_cast<uint64_t>(size & 0x7FFF) << 10;
+    }
+    return static_cast<uint64_t>(size) << 20;
+}
+
+// Speeds of 65535 MT/s and above live in the extended dword field
+uint32_t memorySpeed(const Structure& s, size_t offset, size_t extendedOffset) {
+    uint16_t speed = s.wordAt(offset);
+    if (speed == 0xFFFF) {
+        return s.dwordAt(extendedOffset);
+    }
+    return speed;
+}
+
+#ifndef _WIN32
+std::string readBinaryFile(const std::string& path) {
+    return DataProvider::instance().fetch("file", path, [&path]() {
+        std::ifstream file(path, std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    });
+}
+#endif
+
+}
+
+SmbiosTable SmbiosTable::fromBuffer(std::vector<uint8_t> buffer, size_t offset, uint8_t majorVersion, uint8_t minorVersion) {
+    SmbiosTable table;
+    table.data = std::move(buffer);
+    table.tableOffset = offset;
+    table.major = majorVersion;
+    table.minor = minorVersion;
+    table.parse();
+    return table;
+}
+
+SmbiosTable SmbiosTable::loadFromFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return SmbiosTable();
+    }
+    
+    std::vector<uint8_t> buffer((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    
+    // An RSMB blob announces the length of the table that follows it
+    if (buffer.size() > RSMB_HEADER_SIZE) {
+        uint32_t length;
+        std::memcpy(&length, buffer.data() + 4, sizeof(length));
+        if (buffer[0] <= 1 && length == buffer.size() - RSMB_HEADER_SIZE) {
+            uint8_t majorVersion = buffer[1];
+            uint8_t minorVersion = buffer[2];
+            return fromBuffer(std::move(buffer), RSMB_HEADER_SIZE, majorVersion, minorVersion);
+        }
+    }
+    
+    return fromBuffer(std::move(buffer), 0, 0, 0);
+}
+
+SmbiosTable SmbiosTable::loadFromFirmware() {
+#ifdef _WIN32
+    std::string blob = DataProvider::instance().fetch("firmware", "RSMB", []() {
+        const DWORD provider = 'RSMB';
+        UINT size = GetSystemFirmwareTable(provider, 0, nullptr, 0);
+        if (size <= RSMB_HEADER_SIZE) {
+            return std::string();
+        }
+        
+        std::string raw(size, '\0');
+        if (GetSystemFirmwareTable(provider, 0, &raw[0], size) != size) {
+            return std::string();
+        }
+        return raw;
+    });
+    if (blob.size() <= RSMB_HEADER_SIZE) {
+        return SmbiosTable();
+    }
+    
+    std::vector<uint8_t> buffer(blob.begin(), blob.end());
+    uint8_t majorVersion = buffer[1];
+    uint8_t minorVersion = buffer[2];
+    return fromBuffer(std::move(buffer), RSMB_HEADER_SIZE, majorVersion, minorVersion);
+#else
+    std::string raw = readBinaryFile("/sys/firmware/dmi/tables/DMI");
+    SmbiosTable table = fromBuffer(std::vector<uint8_t>(raw.begin(), raw.end()), 0, 0, 0);
+    
+    // The entry point carries the version: "_SM3_" (64-bit) or "_SM_" (32-bit)
+    std::string entry = readBinaryFile("/sys/firmware/dmi/tables/smbios_entry_point");
+    char anchor[9] = {};
+    if (entry.size() >= sizeof(anchor)) {
+        std::memcpy(anchor, entry.data(), sizeof(anchor));
+        if (std::memcmp(anchor, "_SM3_", 5) == 0) {
+            table.major = static_cast<uint8_t>(anchor[7]);
+            table.minor = static_cast<uint8_t>(anchor[8]);
+        } else if (std::memcmp(anchor, "_SM_", 4) == 0) {
+            table.major = static_cast<uint8_t>(anchor[6]);
+            table.minor = static_cast<uint8_t>(anchor[7]);
+        }
+    }
+    return table;
+#endif
+}
+
+void SmbiosTable::parse() {
+    memory.clear();
+    parsed = false;
+    
+    if (tableOffset >= data.size()) {
+        return;
+    }
+    
+    const uint8_t* p = data.data() + tableOffset;
+    const uint8_t* end = data.data() + data.size();
+    
+    while (p + 4 <= end) {
+        uint8_t type = p[0];
+        uint8_t length = p[1];
+        if (length < 4 || p + length > end) {
+            break;
+        }
+        
+        // The string set ends with a double NUL
+        const char* strings = reinterpret_cast<const char*>(p + length);
+        const char* scan = strings;
+        const char* limit = reinterpret_cast<const char*>(end);
+        while (scan + 1 < limit && !(scan[0] == '\0' && scan[1] == '\0')) {
+            scan++;
+        }
+        if (scan + 1 >= limit) {
+            break;
+        }
+        
+        Structure s = { p, length, strings, scan };
+        
+        switch (type) {
+            case TYPE_BIOS:
+                biosInfo.vendor = s.stringAt(0x04);
+                biosInfo.version = s.stringAt(0x05);
+                biosInfo.releaseDate = s.stringAt(0x08);
+                break;
+            case TYPE_BASEBOARD:
+                // Multi-board systems list the main board first
+                if (boardInfo.product.empty()) {
+                    boardInfo.manufacturer = s.stringAt(0x04);
+                    boardInfo.product = s.stringAt(0x05);
+                    boardInfo.version = s.stringAt(0x06);
+                }
+                break;
+            case TYPE_CHASSIS:
+                if (chassisInfo.manufacturer.empty()) {
+                    chassisInfo.manufacturer = s.stringAt(0x04);
+                    chassisInfo.type = chassisTypeName(s.byteAt(0x05));
+                }
+                break;
+            case TYPE_MEMORY_DEVICE: {
+                SmbiosMemoryDevice device;
+                device.sizeBytes = memoryDeviceSize(s);
+                if (device.sizeBytes == 0) {
+                    break; // Empty slot
+                }
+                device.deviceLocator = s.stringAt(0x10);
+                device.bankLocator = s.stringAt(0x11);
+                device.type = memoryTypeName(s.byteAt(0x12));
+                device.speedMTs = memorySpeed(s, 0x15, 0x54);
+                device.manufacturer = s.stringAt(0x17);
+                device.partNumber = s.stringAt(0x1A);
+                device.configuredSpeedMTs = memorySpeed(s, 0x20, 0x58);
+                memory.push_back(device);
+                break;
+            }
+            default:
+                break;
+        }
+        
+        parsed = true;
+        p = reinterpret_cast<const uint8_t*>(scan + 2);
+        
+        if (type == TYPE_END_OF_TABLE) {
+            break;
+        }
+    }
+}
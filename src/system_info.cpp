@@ -1,7 +1,32 @@
 #include "system_info.h"
+#include "module_registry.h"
+#include "data_provider.h"
+#if WINFETCH_MODULE_FIRMWARE
+#include "smbios.h"
+#endif
+#if WINFETCH_MODULE_CPU
+#include "cpu_topology.h"
+#include "cpu_features.h"
+#endif
+#if WINFETCH_MODULE_MEMORY
+#include "memory_pressure.h"
+#endif
+#if WINFETCH_MODULE_CPU || WINFETCH_MODULE_MEMORY
+#include "container_limits.h"
+#endif
+#if WINFETCH_MODULE_WINDOWS
+#include "security_status.h"
+#endif
+#if WINFETCH_MODULE_PACKAGES
+#include "package_count.h"
+#endif
+#include <cstdlib>
 #include <iostream>
+#include <memory>
 #include <sstream>
 #include <iomanip>
+
+#ifdef _WIN32
 #include <psapi.h>
 #include <powrprof.h>
 #include <wbemidl.h>
@@ -11,29 +36,67 @@
 #pragma comment(lib, "psapi.lib")
 #pragma comment(lib, "powrprof.lib")
 #pragma comment(lib, "wbemuuid.lib")
+#else
+#include <unistd.h>
+#endif
 
 SystemInfo::SystemInfo() {
     gatherAllInfo();
 }
 
+SystemInfo::SystemInfo(unsigned collectors) {
+    refresh(collectors);
+}
+
 void SystemInfo::gatherAllInfo() {
-    gatherOSInfo();
-    gatherCPUInfo();
-    gatherMemoryInfo();
-    gatherGPUInfo();
-    gatherStorageInfo();
-    gatherNetworkInfo();
-    gatherUptimeInfo();
-    gatherWindowsInfo();
+    refresh(COLLECT_ALL);
+}
+
+void SystemInfo::refresh(unsigned collectors) {
+    // Modules left out of the build have empty collectors
+    collectors &= ENABLED_MODULES;
+    
+#if WINFETCH_MODULE_WINDOWS
+    // The security queries can take seconds; they run on their own
+    // threads while the other collectors work
+    std::unique_ptr<SecurityRunner> security;
+    if (collectors & COLLECT_WINDOWS) {
+        security.reset(new SecurityRunner(SecurityProvider::system()));
+        security->start();
+    }
+#endif
+    
+    if (collectors & COLLECT_OS) gatherOSInfo();
+    if (collectors & COLLECT_CPU) gatherCPUInfo();
+    if (collectors & COLLECT_MEMORY) gatherMemoryInfo();
+    if (collectors & (COLLECT_CPU | COLLECT_MEMORY)) gatherContainerInfo();
+    if (collectors & COLLECT_FIRMWARE) gatherFirmwareInfo();
+    if (collectors & COLLECT_GPU) gatherGPUInfo();
+    if (collectors & COLLECT_STORAGE) gatherStorageInfo();
+    if (collectors & COLLECT_NETWORK) gatherNetworkInfo();
+    if (collectors & COLLECT_UPTIME) gatherUptimeInfo();
+    if (collectors & COLLECT_PACKAGES) gatherPackageInfo();
+#if WINFETCH_MODULE_WINDOWS
+    if (security) gatherWindowsInfo(*security);
+#endif
 }
 
 void SystemInfo::gatherOSInfo() {
+#if WINFETCH_MODULE_OS
     // Get OS version information
     OSVERSIONINFOEX osvi;
     ZeroMemory(&osvi, sizeof(OSVERSIONINFOEX));
-    osvi.dwOSVersionInfoSize = sizeof(OSVERSIONINFOEX);
     
-    if (GetVersionEx((OSVERSIONINFO*)&osvi)) {
+    // Off Windows only a replayed capture answers the Win32 queries
+    if (DataProvider::instance().fetchStruct<OSVERSIONINFOEX>("os", "GetVersionEx", osvi, [](OSVERSIONINFOEX& info) {
+#ifdef _WIN32
+            info.dwOSVersionInfoSize = sizeof(OSVERSIONINFOEX);
+            return GetVersionEx((OSVERSIONINFO*)&info) != FALSE;
+#else
+            (void)info;
+            return false;
+#endif
+        })) {
         osName = "Windows";
         osVersion = std::to_string(osvi.dwMajorVersion) + "." + std::to_string(osvi.dwMinorVersion);
         osBuild = std::to_string(osvi.dwBuildNumber);
@@ -76,7 +139,18 @@ void SystemInfo::gatherOSInfo() {
     
     // Get architecture
     SYSTEM_INFO si;
-    GetSystemInfo(&si);
+    ZeroMemory(&si, sizeof(si));
+    if (!DataProvider::instance().fetchStruct<SYSTEM_INFO>("os", "GetSystemInfo", si, [](SYSTEM_INFO& info) {
+#ifdef _WIN32
+        GetSystemInfo(&info);
+        return true;
+#else
+        (void)info;
+        return false;
+#endif
+    })) {
+        si.wProcessorArchitecture = PROCESSOR_ARCHITECTURE_UNKNOWN;
+    }
     switch (si.wProcessorArchitecture) {
         case PROCESSOR_ARCHITECTURE_AMD64:
             architecture = "x64";
@@ -97,44 +171,92 @@ void SystemInfo::gatherOSInfo() {
             architecture = "Unknown";
             break;
     }
+#endif
 }
 
 void SystemInfo::gatherCPUInfo() {
-    // Get CPU information from registry
-    cpuName = getRegistryValue(HKEY_LOCAL_MACHINE, 
-        "HARDWARE\\DESCRIPTION\\System\\CentralProcessor\\0", 
-        "ProcessorNameString");
+#if WINFETCH_MODULE_CPU
+    // Identify the CPU with CPUID; non-x86 builds fall back to the registry
+    CpuIdentity identity = CpuIdentity::detect();
+    cpuName = identity.brand;
     
     if (cpuName.empty()) {
         cpuName = "Unknown CPU";
     }
     
+    if (identity.fromCpuid) {
+        cpuSignature = identity.vendor + " Family " + std::to_string(identity.family) +
+            " Model " + std::to_string(identity.model) + " Stepping " + std::to_string(identity.stepping);
+    }
+    
+    std::string featureList;
+    for (const auto& feature : identity.features) {
+        featureList += (featureList.empty() ? "" : " ") + feature;
+    }
+    if (identity.featureLevel > 0) {
+        cpuFeatures = "x86-64-v" + std::to_string(identity.featureLevel);
+        if (!featureList.empty()) {
+            cpuFeatures += " (" + featureList + ")";
+        }
+    } else {
+        cpuFeatures = featureList;
+    }
+    
+    if (identity.hypervisor) {
+        cpuHypervisor = identity.hypervisorVendor.empty() ? "Yes" : identity.hypervisorVendor;
+    }
+    
     // Get CPU cores and threads
     SYSTEM_INFO si;
-    GetSystemInfo(&si);
-    
-    // Get logical processors (threads) and physical cores
-    DWORD logicalProcessors = 0;
-    DWORD physicalCores = 0;
-    DWORD size = 0;
-    
-    if (GetLogicalProcessorInformation(nullptr, &size)) {
-        std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> buffer(size / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
-        if (GetLogicalProcessorInformation(buffer.data(), &size)) {
-            for (const auto& info : buffer) {
-                if (info.Relationship == RelationProcessorCore) {
-                    physicalCores++;
-                    // Count the number of logical processors (threads) for this core
-                    DWORD mask = info.ProcessorMask;
-                    DWORD threads = 0;
-                    while (mask) {
-                        if (mask & 1) threads++;
-                        mask >>= 1;
-                    }
-                    logicalProcessors += threads;
-                }
+    ZeroMemory(&si, sizeof(si));
+    DataProvider::instance().fetchStruct<SYSTEM_INFO>("os", "GetSystemInfo", si, [](SYSTEM_INFO& info) {
+#ifdef _WIN32
+        GetSystemInfo(&info);
+        return true;
+#else
+        (void)info;
+        return false;
+#endif
+    });
+    
+    // Get logical processors (threads) and physical cores across all
+    // processor groups, plus packages, NUMA nodes and caches
+    CpuTopology topology = CpuTopology::detect();
+    DWORD logicalProcessors = topology.logicalProcessors;
+    DWORD physicalCores = topology.physicalCores;
+    
+    if (topology.hybrid()) {
+        cpuCoreTypes = std::to_string(topology.performanceCores) + "P + " +
+            std::to_string(topology.efficiencyCores) + "E";
+    }
+    
+    if (topology.valid()) {
+        std::ostringstream layout;
+        layout << topology.packages << (topology.packages == 1 ? " package, " : " packages, ")
+               << topology.numaNodes << (topology.numaNodes == 1 ? " NUMA node" : " NUMA nodes");
+        if (topology.processorGroups > 1) {
+            layout << ", " << topology.processorGroups << " processor groups";
+        }
+        cpuTopology = layout.str();
+        
+        std::ostringstream caches;
+        for (const auto& cache : topology.caches) {
+            if (caches.tellp() > 0) {
+                caches << ", ";
+            }
+            caches << "L" << cache.level;
+            if (cache.type != 'U') {
+                caches << static_cast<char>(cache.type + ('a' - 'A'));
+            }
+            caches << " " << formatBytes(cache.sizeBytes);
+            if (cache.instances > 1) {
+                caches << " x" << cache.instances;
+            }
+            if (cache.sharedBy > 1) {
+                caches << " (" << cache.sharedBy << " threads each)";
             }
         }
+        cpuCache = caches.str();
     }
     
     // Fallback if the above method fails
@@ -180,55 +302,169 @@ void SystemInfo::gatherCPUInfo() {
     cpuCores = std::to_string(physicalCores);
     cpuThreads = std::to_string(logicalProcessors);
     
-    // Get CPU frequency
-    HKEY hKey;
-    if (RegOpenKeyEx(HKEY_LOCAL_MACHINE, 
-        "HARDWARE\\DESCRIPTION\\System\\CentralProcessor\\0", 
-        0, KEY_READ, &hKey) == ERROR_SUCCESS) {
-        
-        DWORD frequency = 0;
-        DWORD size = sizeof(frequency);
-        if (RegQueryValueEx(hKey, "~MHz", nullptr, nullptr, 
-            reinterpret_cast<LPBYTE>(&frequency), &size) == ERROR_SUCCESS) {
-            cpuFrequency = std::to_string(frequency) + " MHz";
-        }
-        RegCloseKey(hKey);
-    }
-    
-    // Try to get actual RAM speed from WMI
-    std::string ramSpeed = executeCommand("wmic memorychip get speed /value");
-    if (!ramSpeed.empty()) {
-        size_t pos = ramSpeed.find("Speed=");
-        if (pos != std::string::npos) {
-            size_t start = pos + 6;
-            size_t end = ramSpeed.find('\n', start);
-            if (end == std::string::npos) end = ramSpeed.length();
-            std::string speed = ramSpeed.substr(start, end - start);
-            speed.erase(0, speed.find_first_not_of(" \t\r\n"));
-            speed.erase(speed.find_last_not_of(" \t\r\n") + 1);
-            if (!speed.empty() && speed != "0") {
-                // Update CPU frequency to show RAM speed instead
-                cpuFrequency = "RAM: " + speed + " MHz";
-            }
+    // Get CPU frequency, from CPUID leaf 0x16 when the CPU reports it
+    if (identity.baseMHz > 0) {
+        cpuFrequency = std::to_string(identity.baseMHz) + " MHz";
+        if (identity.maxMHz > identity.baseMHz) {
+            cpuFrequency += " (max " + std::to_string(identity.maxMHz) + " MHz)";
         }
+    } else if (identity.maxMHz > 0) {
+        cpuFrequency = std::to_string(identity.maxMHz) + " MHz";
     }
+    
+    DWORD frequency = 0;
+    if (cpuFrequency.empty() && DataProvider::instance().fetchStruct<DWORD>("registry",
+        "HKLM\\HARDWARE\\DESCRIPTION\\System\\CentralProcessor\\0\\~MHz", frequency, [](DWORD& value) {
+#ifdef _WIN32
+            HKEY hKey;
+            if (RegOpenKeyEx(HKEY_LOCAL_MACHINE, 
+                "HARDWARE\\DESCRIPTION\\System\\CentralProcessor\\0", 
+                0, KEY_READ, &hKey) != ERROR_SUCCESS) {
+                return false;
+            }
+            
+            DWORD size = sizeof(value);
+            bool found = RegQueryValueEx(hKey, "~MHz", nullptr, nullptr, 
+                reinterpret_cast<LPBYTE>(&value), &size) == ERROR_SUCCESS;
+            RegCloseKey(hKey);
+            return found;
+#else
+            (void)value;
+            return false;
+#endif
+        })) {
+        cpuFrequency = std::to_string(frequency) + " MHz";
+    }
+#endif
 }
 
 void SystemInfo::gatherMemoryInfo() {
+#if WINFETCH_MODULE_MEMORY
     MEMORYSTATUSEX memStatus;
-    memStatus.dwLength = sizeof(memStatus);
+    ZeroMemory(&memStatus, sizeof(memStatus));
+    
+    // Sampled on every watch tick along with the usage below
+    MemoryPressure pressure = MemoryPressure::sample();
     
-    if (GlobalMemoryStatusEx(&memStatus)) {
+    bool haveStatus = DataProvider::instance().fetchStruct<MEMORYSTATUSEX>("memory", "GlobalMemoryStatusEx", memStatus, [](MEMORYSTATUSEX& status) {
+#ifdef _WIN32
+            status.dwLength = sizeof(status);
+            return GlobalMemoryStatusEx(&status) != FALSE;
+#else
+            (void)status;
+            return false;
+#endif
+        });
+    if (!haveStatus && pressure.totalBytes > 0) {
+        // Off Windows the host totals come from /proc/meminfo
+        memStatus.ullTotalPhys = pressure.totalBytes;
+        memStatus.ullAvailPhys = pressure.availableBytes;
+        haveStatus = true;
+    }
+    
+    if (haveStatus && memStatus.ullTotalPhys > 0) {
         totalMemory = formatBytes(memStatus.ullTotalPhys);
         availableMemory = formatBytes(memStatus.ullAvailPhys);
+        totalMemoryBytes = memStatus.ullTotalPhys;
+        availableMemoryBytes = memStatus.ullAvailPhys;
         
         // Calculate memory usage percentage
         double usagePercent = ((double)(memStatus.ullTotalPhys - memStatus.ullAvailPhys) / memStatus.ullTotalPhys) * 100.0;
         memoryUsage = std::to_string(static_cast<int>(usagePercent)) + "%";
     }
+    
+    commitBytes = pressure.commitBytes;
+    commitLimitBytes = pressure.commitLimitBytes;
+    swapTotalBytes = pressure.swapTotalBytes;
+    swapUsedBytes = pressure.swapUsedBytes;
+    cachedBytes = pressure.cachedBytes;
+    dirtyBytes = pressure.dirtyBytes;
+    
+    memoryCommit.clear();
+    if (pressure.commitLimitBytes > 0) {
+        memoryCommit = formatBytes(pressure.commitBytes) + " / " + formatBytes(pressure.commitLimitBytes);
+    }
+    
+    memorySwap.clear();
+    if (pressure.swapTotalBytes > 0) {
+        memorySwap = formatBytes(pressure.swapUsedBytes) + " / " + formatBytes(pressure.swapTotalBytes);
+    }
+    
+    memoryCache.clear();
+    if (pressure.cachedBytes > 0 || pressure.dirtyBytes > 0) {
+        memoryCache = formatBytes(pressure.cachedBytes) + " cached, " + formatBytes(pressure.dirtyBytes) + " dirty";
+    }
+    
+    memoryHugePages.clear();
+    if (pressure.hugePagesTotal > 0) {
+        memoryHugePages = std::to_string(pressure.hugePagesTotal - pressure.hugePagesFree) + " / " +
+            std::to_string(pressure.hugePagesTotal) + " x " + formatBytes(pressure.hugePageBytes);
+    }
+    if (pressure.transparentHugeBytes > 0) {
+        memoryHugePages += (memoryHugePages.empty() ? "" : ", ") + formatBytes(pressure.transparentHugeBytes) + " transparent";
+    }
+    
+    memoryPressure.clear();
+    if (pressure.hasPressure) {
+        // Percent of time stalled over the last 10s / 60s / 300s
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(2)
+            << "some " << pressure.someAvg[0] << "/" << pressure.someAvg[1] << "/" << pressure.someAvg[2]
+            << ", full " << pressure.fullAvg[0] << "/" << pressure.fullAvg[1] << "/" << pressure.fullAvg[2];
+        memoryPressure = oss.str();
+    }
+#endif
+}
+
+void SystemInfo::gatherFirmwareInfo() {
+#if WINFETCH_MODULE_FIRMWARE
+    memoryModules.clear();
+    
+    // One firmware table read covers memory modules, board, BIOS and chassis
+    SmbiosTable smbios = SmbiosTable::loadFromFirmware();
+    if (!smbios.valid()) {
+        return;
+    }
+    
+    for (const auto& dimm : smbios.memoryDevices()) {
+        std::ostringstream oss;
+        oss << (dimm.deviceLocator.empty() ? std::string_view("DIMM") : dimm.deviceLocator) << ": "
+            << formatBytes(dimm.sizeBytes) << " " << dimm.type;
+        
+        uint32_t speed = dimm.configuredSpeedMTs ? dimm.configuredSpeedMTs : dimm.speedMTs;
+        if (speed) {
+            oss << " " << speed << " MT/s";
+        }
+        
+        if (!dimm.manufacturer.empty() || !dimm.partNumber.empty()) {
+            oss << " (" << dimm.manufacturer;
+            if (!dimm.manufacturer.empty() && !dimm.partNumber.empty()) {
+                oss << " ";
+            }
+            oss << dimm.partNumber << ")";
+        }
+        memoryModules.push_back(oss.str());
+    }
+    
+    const SmbiosBoard& board = smbios.board();
+    if (!board.product.empty()) {
+        boardName = std::string(board.manufacturer) + " " + std::string(board.product);
+    }
+    
+    const SmbiosBios& bios = smbios.bios();
+    if (!bios.version.empty()) {
+        biosVersion = std::string(bios.vendor) + " " + std::string(bios.version);
+        if (!bios.releaseDate.empty()) {
+            biosVersion += " (" + std::string(bios.releaseDate) + ")";
+        }
+    }
+    
+    chassisType = smbios.chassis().type;
+#endif
 }
 
 void SystemInfo::gatherGPUInfo() {
+#if WINFETCH_MODULE_GPU
     gpuName = "Unknown GPU";
     gpuDriver = "Unknown";
     gpuMemory = "Unknown";
@@ -362,67 +598,130 @@ void SystemInfo::gatherGPUInfo() {
     if (gpuName.empty()) {
         gpuName = "Unknown GPU";
     }
+#endif
 }
 
 void SystemInfo::gatherStorageInfo() {
+#if WINFETCH_MODULE_STORAGE
     drives.clear();
     driveSizes.clear();
     driveFree.clear();
+    driveSizeBytes.clear();
+    driveFreeBytes.clear();
     
-    DWORD drives = GetLogicalDrives();
+    DataProvider& provider = DataProvider::instance();
+    DWORD drives = 0;
+    provider.fetchStruct<DWORD>("storage", "GetLogicalDrives", drives, [](DWORD& mask) {
+#ifdef _WIN32
+        mask = GetLogicalDrives();
+        return true;
+#else
+        (void)mask;
+        return false;
+#endif
+    });
     char driveLetter = 'A';
     
     for (int i = 0; i < 26; i++) {
         if (drives & (1 << i)) {
             std::string drive = std::string(1, driveLetter) + ":";
             
-            ULARGE_INTEGER freeBytesAvailable, totalNumberOfBytes, totalNumberOfFreeBytes;
+            struct DiskSpace {
+                ULARGE_INTEGER freeBytesAvailable, totalNumberOfBytes, totalNumberOfFreeBytes;
+            } space;
             
-            if (GetDiskFreeSpaceEx(drive.c_str(), &freeBytesAvailable, &totalNumberOfBytes, &totalNumberOfFreeBytes)) {
+            if (provider.fetchStruct<DiskSpace>("storage", "GetDiskFreeSpaceEx " + drive, space, [&drive](DiskSpace& value) {
+#ifdef _WIN32
+                    return GetDiskFreeSpaceEx(drive.c_str(), &value.freeBytesAvailable,
+                        &value.totalNumberOfBytes, &value.totalNumberOfFreeBytes) != FALSE;
+#else
+                    (void)value;
+                    return false;
+#endif
+                })) {
                 this->drives.push_back(drive);
-                driveSizes.push_back(formatBytes(totalNumberOfBytes.QuadPart));
-                driveFree.push_back(formatBytes(freeBytesAvailable.QuadPart));
+                driveSizes.push_back(formatBytes(space.totalNumberOfBytes.QuadPart));
+                driveFree.push_back(formatBytes(space.freeBytesAvailable.QuadPart));
+                driveSizeBytes.push_back(space.totalNumberOfBytes.QuadPart);
+                driveFreeBytes.push_back(space.freeBytesAvailable.QuadPart);
             }
         }
         driveLetter++;
     }
+#endif
 }
 
 void SystemInfo::gatherNetworkInfo() {
+#if WINFETCH_MODULE_NETWORK
+    DataProvider& provider = DataProvider::instance();
+    
     // Get hostname
-    char hostname[256];
-    if (gethostname(hostname, sizeof(hostname)) == 0) {
-        this->hostname = hostname;
-    } else {
+    this->hostname = provider.fetch("network", "gethostname", []() {
+        char hostname[256];
+        return gethostname(hostname, sizeof(hostname)) == 0 ? std::string(hostname) : std::string();
+    });
+    if (this->hostname.empty()) {
         this->hostname = "Unknown";
     }
     
     // Get username
-    char username[256];
-    DWORD size = sizeof(username);
-    if (GetUserName(username, &size)) {
-        this->username = username;
-    } else {
+    this->username = provider.fetch("network", "GetUserName", []() {
+#ifdef _WIN32
+        char username[256];
+        DWORD size = sizeof(username);
+        return GetUserName(username, &size) ? std::string(username) : std::string();
+#else
+        return std::string();
+#endif
+    });
+    if (this->username.empty()) {
         this->username = "Unknown";
     }
     
     // Get domain
-    char domain[256];
-    DWORD domainSize = sizeof(domain);
-    if (GetComputerName(domain, &domainSize)) {
-        this->domain = domain;
-    } else {
+    this->domain = provider.fetch("network", "GetComputerName", []() {
+#ifdef _WIN32
+        char domain[256];
+        DWORD domainSize = sizeof(domain);
+        return GetComputerName(domain, &domainSize) ? std::string(domain) : std::string();
+#else
+        return std::string();
+#endif
+    });
+    if (this->domain.empty()) {
         this->domain = "Unknown";
     }
+#endif
 }
 
 void SystemInfo::gatherUptimeInfo() {
-    DWORD uptime = GetTickCount();
+#if WINFETCH_MODULE_UPTIME
+    DataProvider& provider = DataProvider::instance();
+    
+    // GetTickCount() wraps after 49.7 days
+    ULONGLONG uptime = 0;
+    provider.fetchStruct<ULONGLONG>("uptime", "GetTickCount64", uptime, [](ULONGLONG& ticks) {
+#ifdef _WIN32
+        ticks = GetTickCount64();
+        return true;
+#else
+        (void)ticks;
+        return false;
+#endif
+    });
     this->uptime = formatUptime(uptime);
+    this->uptimeSeconds = uptime / 1000;
     
     // Get timezone
     TIME_ZONE_INFORMATION tzi;
-    if (GetTimeZoneInformation(&tzi) != TIME_ZONE_ID_INVALID) {
+    if (provider.fetchStruct<TIME_ZONE_INFORMATION>("uptime", "GetTimeZoneInformation", tzi, [](TIME_ZONE_INFORMATION& info) {
+#ifdef _WIN32
+            return GetTimeZoneInformation(&info) != TIME_ZONE_ID_INVALID;
+#else
+            (void)info;
+            return false;
+#endif
+        })) {
         // Convert to readable format (simplified)
         this->timezone = "UTC" + std::to_string(-tzi.Bias / 60);
     } else {
@@ -430,60 +729,151 @@ void SystemInfo::gatherUptimeInfo() {
     }
     
     // Get language
-    char locale[256];
-    if (GetLocaleInfo(LOCALE_USER_DEFAULT, LOCALE_SLANGUAGE, locale, sizeof(locale))) {
-        this->language = locale;
-    } else {
+    this->language = provider.fetch("uptime", "GetLocaleInfo LOCALE_SLANGUAGE", []() {
+#ifdef _WIN32
+        char locale[256];
+        return GetLocaleInfo(LOCALE_USER_DEFAULT, LOCALE_SLANGUAGE, locale, sizeof(locale)) ? std::string(locale) : std::string();
+#else
+        return std::string();
+#endif
+    });
+    if (this->language.empty()) {
         this->language = "Unknown";
     }
+#endif
 }
 
+#if WINFETCH_MODULE_WINDOWS
 void SystemInfo::gatherWindowsInfo() {
-    // Windows activation status (simplified)
-    windowsActivation = "Unknown";
+    SecurityRunner security(SecurityProvider::system());
+    gatherWindowsInfo(security);
+}
+
+void SystemInfo::gatherWindowsInfo(SecurityRunner& security) {
+    // Activation, Defender and Windows Update status, cached per TTL
+    SecurityReport report = security.collect();
+    windowsActivation = report.activation;
+    windowsDefender = report.defender;
+    windowsUpdate = report.update;
+}
+#else
+void SystemInfo::gatherWindowsInfo() {
+}
+#endif
+
+void SystemInfo::gatherPackageInfo() {
+#if WINFETCH_MODULE_PACKAGES
+    packages.clear();
+    packageCounts.clear();
     
-    // Windows Defender status (simplified)
-    windowsDefender = "Unknown";
+    // One "source count" pair per line
+    std::string counts = DataProvider::instance().fetch("packages", "countAll", []() {
+        std::string lines;
+        for (const auto& count : PackageCounter::countAll()) {
+            lines += count.source + " " + std::to_string(count.count) + "\n";
+        }
+        return lines;
+    });
     
-    // Windows Update status (simplified)
-    windowsUpdate = "Unknown";
+    for (const auto& line : splitString(counts, '\n')) {
+        size_t space = line.rfind(' ');
+        if (space == std::string::npos) {
+            continue;
+        }
+        
+        std::string source = line.substr(0, space);
+        unsigned long long count = std::strtoull(line.c_str() + space + 1, nullptr, 10);
+        packageCounts.emplace_back(source, count);
+        if (!packages.empty()) {
+            packages += ", ";
+        }
+        packages += std::to_string(count) + " (" + source + ")";
+    }
+#endif
 }
 
-std::string SystemInfo::executeCommand(const std::string& command) {
-    std::string result;
-    char buffer[128];
+void SystemInfo::gatherContainerInfo() {
+#if WINFETCH_MODULE_CPU || WINFETCH_MODULE_MEMORY
+    container.clear();
+    cpuLimit.clear();
+    memoryLimit.clear();
+    memoryLimitBytes = 0;
     
-    FILE* pipe = _popen(command.c_str(), "r");
-    if (!pipe) {
-        return "";
-    }
+    // Host totals stay as they are; the limits are reported next to them
+    ContainerLimits limits = ContainerLimits::detect();
+    container = limits.container;
     
-    while (fgets(buffer, sizeof(buffer), pipe) != nullptr) {
-        result += buffer;
+    if (limits.memoryLimited() && (totalMemoryBytes == 0 || limits.memoryLimitBytes < totalMemoryBytes)) {
+        memoryLimitBytes = limits.memoryLimitBytes;
+        memoryLimit = formatBytes(limits.memoryLimitBytes);
+        if (limits.memoryUsedBytes > 0) {
+            memoryLimit += " (" + std::to_string(limits.memoryUsedBytes * 100 / limits.memoryLimitBytes) + "% used)";
+        }
     }
     
-    _pclose(pipe);
-    return result;
+    if (limits.cpuLimited()) {
+        std::ostringstream oss;
+        if (limits.cpuQuota > 0) {
+            oss << std::setprecision(3) << limits.cpuQuota << (limits.cpuQuota == 1 ? " CPU" : " CPUs");
+        }
+        if (!limits.cpuset.empty() && limits.cpuset.size() < limits.hostCpus) {
+            oss << (limits.cpuQuota > 0 ? " on " : "") << limits.cpuset.size() << " of " << limits.hostCpus << " CPUs";
+        }
+        cpuLimit = oss.str();
+    }
+#endif
+}
+
+std::string SystemInfo::executeCommand(const std::string& command) {
+    return DataProvider::instance().fetch("command", command, [&command]() {
+#ifdef _WIN32
+        std::string result;
+        char buffer[128];
+        
+        FILE* pipe = _popen(command.c_str(), "r");
+        if (!pipe) {
+            return std::string();
+        }
+        
+        while (fgets(buffer, sizeof(buffer), pipe) != nullptr) {
+            result += buffer;
+        }
+        
+        _pclose(pipe);
+        return result;
+#else
+        // The commands are Windows tools (wmic); they are not run here
+        return std::string();
+#endif
+    });
 }
 
 std::string SystemInfo::getRegistryValue(HKEY hKey, const std::string& subKey, const std::string& valueName) {
-    HKEY hSubKey;
-    if (RegOpenKeyEx(hKey, subKey.c_str(), 0, KEY_READ, &hSubKey) != ERROR_SUCCESS) {
-        return "";
-    }
-    
-    char buffer[1024];
-    DWORD bufferSize = sizeof(buffer);
-    DWORD type;
+    std::string hive = hKey == HKEY_LOCAL_MACHINE ? "HKLM" : hKey == HKEY_CURRENT_USER ? "HKCU" : "HKEY";
     
-    if (RegQueryValueEx(hSubKey, valueName.c_str(), nullptr, &type, 
-        reinterpret_cast<LPBYTE>(buffer), &bufferSize) == ERROR_SUCCESS) {
+    return DataProvider::instance().fetch("registry", hive + "\\" + subKey + "\\" + valueName, [&]() {
+#ifdef _WIN32
+        HKEY hSubKey;
+        if (RegOpenKeyEx(hKey, subKey.c_str(), 0, KEY_READ, &hSubKey) != ERROR_SUCCESS) {
+            return std::string();
+        }
+        
+        char buffer[1024];
+        DWORD bufferSize = sizeof(buffer);
+        DWORD type;
+        
+        if (RegQueryValueEx(hSubKey, valueName.c_str(), nullptr, &type, 
+            reinterpret_cast<LPBYTE>(buffer), &bufferSize) == ERROR_SUCCESS) {
+            RegCloseKey(hSubKey);
+            return std::string(buffer);
+        }
+        
         RegCloseKey(hSubKey);
-        return std::string(buffer);
-    }
-    
-    RegCloseKey(hSubKey);
-    return "";
+        return std::string();
+#else
+        return std::string();
+#endif
+    });
 }
 
 std::string SystemInfo::formatBytes(DWORDLONG bytes) {
@@ -501,10 +891,10 @@ std::string SystemInfo::formatBytes(DWORDLONG bytes) {
     return oss.str();
 }
 
-std::string SystemInfo::formatUptime(DWORD uptimeMs) {
-    DWORD days = uptimeMs / (1000 * 60 * 60 * 24);
-    DWORD hours = (uptimeMs % (1000 * 60 * 60 * 24)) / (1000 * 60 * 60);
-    DWORD minutes = (uptimeMs % (1000 * 60 * 60)) / (1000 * 60);
+std::string SystemInfo::formatUptime(ULONGLONG uptimeMs) {
+    ULONGLONG days = uptimeMs / (1000 * 60 * 60 * 24);
+    ULONGLONG hours = (uptimeMs % (1000 * 60 * 60 * 24)) / (1000 * 60 * 60);
+    ULONGLONG minutes = (uptimeMs % (1000 * 60 * 60)) / (1000 * 60);
     
     std::ostringstream oss;
     if (days > 0) {
@@ -529,3 +919,111 @@ std::vector<std::string> SystemInfo::splitString(const std::string& str, char de
     
     return tokens;
 }
+
+std::vector<std::pair<std::string, std::string>> SystemInfo::toKeyValues(unsigned collectors) const {
+    collectors &= ENABLED_MODULES;
+    
+    std::vector<std::pair<std::string, std::string>> values;
+    auto add = [&values](const std::string& key, const std::string& value) {
+        if (!value.empty()) {
+            values.emplace_back(key, value);
+        }
+    };
+    
+    if (collectors & COLLECT_OS) {
+        add("os", windowsEdition);
+        add("os_version", osVersion);
+        add("os_build", osBuild);
+        add("architecture", architecture);
+    }
+    if (collectors & COLLECT_CPU) {
+        add("cpu", cpuName);
+        add("cpu_cores", cpuCores);
+        add("cpu_threads", cpuThreads);
+        add("cpu_core_types", cpuCoreTypes);
+        add("cpu_frequency", cpuFrequency);
+        add("cpu_topology", cpuTopology);
+        add("cpu_cache", cpuCache);
+        add("cpu_signature", cpuSignature);
+        add("cpu_features", cpuFeatures);
+        add("cpu_hypervisor", cpuHypervisor);
+        add("cpu_limit", cpuLimit);
+        add("container", container);
+    }
+    if (collectors & COLLECT_MEMORY) {
+        add("memory_total", totalMemory);
+        add("memory_available", availableMemory);
+        add("memory_usage", memoryUsage);
+        if (totalMemoryBytes > 0) {
+            add("memory_total_bytes", std::to_string(totalMemoryBytes));
+            add("memory_available_bytes", std::to_string(availableMemoryBytes));
+        }
+        add("memory_limit", memoryLimit);
+        if (memoryLimitBytes > 0) {
+            add("memory_limit_bytes", std::to_string(memoryLimitBytes));
+        }
+        add("memory_commit", memoryCommit);
+        if (commitLimitBytes > 0) {
+            add("memory_commit_bytes", std::to_string(commitBytes));
+            add("memory_commit_limit_bytes", std::to_string(commitLimitBytes));
+        }
+        add("memory_swap", memorySwap);
+        if (swapTotalBytes > 0) {
+            add("memory_swap_used_bytes", std::to_string(swapUsedBytes));
+            add("memory_swap_total_bytes", std::to_string(swapTotalBytes));
+        }
+        add("memory_cache", memoryCache);
+        add("memory_cached_bytes", std::to_string(cachedBytes));
+        add("memory_dirty_bytes", std::to_string(dirtyBytes));
+        add("memory_huge_pages", memoryHugePages);
+        add("memory_pressure", memoryPressure);
+    }
+    if (collectors & COLLECT_FIRMWARE) {
+        for (size_t i = 0; i < memoryModules.size(); i++) {
+            add("memory_module." + std::to_string(i), memoryModules[i]);
+        }
+        add("board", boardName);
+        add("bios", biosVersion);
+        add("chassis", chassisType);
+    }
+    if (collectors & COLLECT_GPU) {
+        add("gpu", gpuName);
+        add("gpu_driver", gpuDriver);
+    }
+    if (collectors & COLLECT_STORAGE) {
+        for (size_t i = 0; i < drives.size(); i++) {
+            add("drive." + drives[i] + ".size", driveSizes[i]);
+            add("drive." + drives[i] + ".free", driveFree[i]);
+            add("drive." + drives[i] + ".size_bytes", std::to_string(driveSizeBytes[i]));
+            add("drive." + drives[i] + ".free_bytes", std::to_string(driveFreeBytes[i]));
+        }
+    }
+    if (collectors & COLLECT_NETWORK) {
+        add("hostname", hostname);
+        add("username", username);
+        add("computer_name", domain);
+    }
+    if (collectors & COLLECT_UPTIME) {
+        add("uptime", uptime);
+        add("uptime_seconds", std::to_string(uptimeSeconds));
+        add("timezone", timezone);
+        add("language", language);
+    }
+    if (collectors & COLLECT_PACKAGES) {
+        add("packages", packages);
+        for (const auto& count : packageCounts) {
+            add("packages." + count.first, std::to_string(count.second));
+        }
+    }
+    if (collectors & COLLECT_WINDOWS) {
+        add("windows_activation", windowsActivation);
+        add("windows_defender", windowsDefender);
+        add("windows_update", windowsUpdate);
+    }
+    
+    for (const auto& module : customModules) {
+        add("module." + module.name, module.value);
+    }
+    
+    return values;
+}
@@ -0,0 +1,240 @@
+#include "winfetch.h"
+#include "config.h"
+#include "plugin_modules.h"
+#include "system_info.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <future>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+// Collected once per handle; everything else is collected per query
+const unsigned STATIC_COLLECTORS = COLLECT_OS | COLLECT_CPU | COLLECT_FIRMWARE | COLLECT_GPU | COLLECT_NETWORK;
+
+}
+
+struct winfetch_result {
+    std::vector<std::pair<std::string, std::string>> values;
+};
+
+struct winfetch_handle {
+    Config config;
+    
+    // SystemInfo is not thread-safe; queries take turns collecting
+    std::mutex collectMutex;
+    SystemInfo info{ 0u };
+    unsigned cached = 0;
+    
+    // Outstanding asynchronous queries, so close() can wait for them
+    std::mutex pendingMutex;
+    std::condition_variable idle;
+    unsigned pending = 0;
+    
+    void beginAsync() {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        pending++;
+    }
+    
+    void endAsync() {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        if (--pending == 0) {
+            idle.notify_all();
+        }
+    }
+};
+
+struct winfetch_request {
+    std::future<winfetch_result*> future;
+    bool taken = false;
+};
+
+namespace {
+
+winfetch_result* runQuery(winfetch_handle* handle, unsigned fields) {
+    try {
+        unsigned collectors = fields & COLLECT_ALL;
+        
+        // Custom modules run while the built-in collectors work
+        PluginRunner plugins(handle->config);
+        bool custom = (fields & WINFETCH_FIELD_CUSTOM) != 0;
+        if (custom) {
+            plugins.start();
+        }
+        
+        winfetch_result* result = new winfetch_result;
+        {
+            std::lock_guard<std::mutex> lock(handle->collectMutex);
+            unsigned stale = (collectors & ~STATIC_COLLECTORS) | (collectors & STATIC_COLLECTORS & ~handle->cached);
+            handle->info.refresh(stale);
+            handle->cached |= collectors & STATIC_COLLECTORS;
+            result->values = handle->info.toKeyValues(collectors);
+        }
+        
+        if (custom) {
+            for (const auto& module : plugins.collect()) {
+                result->values.emplace_back("module." + module.name, module.value);
+            }
+        }
+        
+        return result;
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+}
+
+extern "C" {
+
+int winfetch_api_version(void) {
+    return WINFETCH_API_VERSION;
+}
+
+winfetch_handle* winfetch_open(const char* config_path) {
+    try {
+        winfetch_handle* handle = new winfetch_handle;
+        if (config_path && *config_path) {
+            handle->config.loadFromFile(config_path);
+        }
+        return handle;
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void winfetch_close(winfetch_handle* handle) {
+    if (!handle) {
+        return;
+    }
+    
+    {
+        std::unique_lock<std::mutex> lock(handle->pendingMutex);
+        handle->idle.wait(lock, [handle] { return handle->pending == 0; });
+    }
+    delete handle;
+}
+
+void winfetch_invalidate(winfetch_handle* handle, unsigned fields) {
+    if (!handle) {
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(handle->collectMutex);
+    handle->cached &= ~fields;
+}
+
+winfetch_result* winfetch_query(winfetch_handle* handle, unsigned fields) {
+    if (!handle) {
+        return nullptr;
+    }
+    return runQuery(handle, fields);
+}
+
+int winfetch_query_async(winfetch_handle* handle, unsigned fields, winfetch_callback callback, void* user_data) {
+    if (!handle || !callback) {
+        return -1;
+    }
+    
+    try {
+        handle->beginAsync();
+        std::thread([handle, fields, callback, user_data] {
+            callback(runQuery(handle, fields), user_data);
+            handle->endAsync();
+        }).detach();
+        return 0;
+    } catch (...) {
+        handle->endAsync();
+        return -1;
+    }
+}
+
+winfetch_request* winfetch_query_start(winfetch_handle* handle, unsigned fields) {
+    if (!handle) {
+        return nullptr;
+    }
+    
+    winfetch_request* request = nullptr;
+    try {
+        request = new winfetch_request;
+    } catch (...) {
+        return nullptr;
+    }
+    
+    try {
+        handle->beginAsync();
+        request->future = std::async(std::launch::async, [handle, fields] {
+            winfetch_result* result = runQuery(handle, fields);
+            handle->endAsync();
+            return result;
+        });
+        return request;
+    } catch (...) {
+        // The task never started, so close() must not wait for it
+        handle->endAsync();
+        delete request;
+        return nullptr;
+    }
+}
+
+winfetch_result* winfetch_request_wait(winfetch_request* request, unsigned timeout_ms) {
+    if (!request || request->taken) {
+        return nullptr;
+    }
+    
+    if (request->future.wait_for(std::chrono::milliseconds(timeout_ms)) != std::future_status::ready) {
+        return nullptr;
+    }
+    
+    request->taken = true;
+    return request->future.get();
+}
+
+void winfetch_request_free(winfetch_request* request) {
+    if (!request) {
+        return;
+    }
+    
+    if (!request->taken && request->future.valid()) {
+        winfetch_result_free(request->future.get());
+    }
+    delete request;
+}
+
+size_t winfetch_result_count(const winfetch_result* result) {
+    return result ? result->values.size() : 0;
+}
+
+const char* winfetch_result_key(const winfetch_result* result, size_t index) {
+    if (!result || index >= result->values.size()) {
+        return nullptr;
+    }
+    return result->values[index].first.c_str();
+}
+
+const char* winfetch_result_value(const winfetch_result* result, size_t index) {
+    if (!result || index >= result->values.size()) {
+        return nullptr;
+    }
+    return result->values[index].second.c_str();
+}
+
+const char* winfetch_result_get(const winfetch_result* result, const char* key) {
+    if (!result || !key) {
+        return nullptr;
+    }
+    for (const auto& entry : result->values) {
+        if (entry.first == key) {
+            return entry.second.c_str();
+        }
+    }
+    return nullptr;
+}
+
+void winfetch_result_free(winfetch_result* result) {
+    delete result;
+}
+
+}